@@ -0,0 +1,158 @@
+/*
+  Library Benchmarks.c
+
+  Times a fixed battery of library calls and prints one comma separated
+  line per call:
+
+    bench,model,name,ticks,reps
+
+  ticks is the fastest of reps calls in system clock ticks, less the cost
+  of timing an empty call.  Run it once per memory model (Project Options
+  > Memory Model) and save the terminal output.  benchsize (Simple
+  Libraries/Utility/libsimpletools/tools) adds code sizes from each
+  model's .elf file and compares two saved runs.
+
+  Lines starting with # are comments.  interpolate is skipped unless the
+  EEPROM holds ActivityBot calibration data.
+
+  http://learn.parallax.com/propeller-c-simple-protocols
+*/
+
+#include "simpletools.h"                      // Include simple tools
+#include "datetime.h"
+#include "gps.h"
+#include "abdrive.h"
+#include "badgetools.h"
+
+#if defined(__PROPELLER_XMMC__)
+#define MODEL "xmmc"
+#elif defined(__PROPELLER_XMM__)
+#define MODEL "xmm"
+#elif defined(__PROPELLER_CMM__)
+#define MODEL "cmm"
+#elif defined(__PROPELLER_LMM__)
+#define MODEL "lmm"
+#else
+#define MODEL "host"
+#endif
+
+#define REPS 10
+
+extern gps_byte_t inBuff[];                   // gps_run.c's NMEA parser
+void PrepBuff();
+void ParseRMC();
+void interpolation_table_setup();             // abdrive.c's speed tables
+void interpolate(int *ltmp, int *rtmp);
+extern volatile screen *self;                 // badgetools OLED state
+
+static char str[64];
+static i2c eeBus;
+static screen oled;
+static int overhead;
+
+static void nothing(void)
+{
+}
+
+static void bench_print(void)
+{
+  print("#%d\n", 12345);
+}
+
+static void bench_sprint(void)
+{
+  sprint(str, "%d %s", 12345, "abc");
+}
+
+static void bench_float2string(void)
+{
+  float2string(3.14159, str, 8, 5);
+}
+
+static void bench_i2c(void)
+{
+  i2c_start(&eeBus);
+  i2c_writeByte(&eeBus, 0xA0);
+  i2c_stop(&eeBus);
+}
+
+static void bench_shift_out(void)
+{
+  shift_out(26, 27, MSBFIRST, 8, 0xA5);
+}
+
+static void bench_ee_getInt(void)
+{
+  ee_getInt(32768);
+}
+
+static void bench_interpolate(void)
+{
+  int left = 64, right = 64;
+  interpolate(&left, &right);
+}
+
+static void bench_dt_fromEt(void)
+{
+  dt_fromEt(1400000000);
+}
+
+static void bench_nmea(void)
+{
+  strcpy((char *) inBuff, "GPRMC,123519,A,4807.038,N,01131.000,E,022.4,"
+         "084.4,230394,003.1,W*6A\r");
+  PrepBuff();
+  ParseRMC();
+}
+
+static void bench_line(void)
+{
+  line(0, 0, 127, 63, 1);
+}
+
+static int ticks(void (*fn)(void))
+{
+  int best = 0x7FFFFFFF;
+  for(int i = 0; i < REPS; i++)
+  {
+    int t = CNT;
+    fn();
+    t = CNT - t;
+    if(t < best) best = t;
+  }
+  return best;
+}
+
+static void bench(const char *name, void (*fn)(void))
+{
+  int t = ticks(fn) - overhead;
+  print("bench,%s,%s,%d,%d\n", MODEL, name, t, REPS);
+}
+
+int main()
+{
+  overhead = ticks(nothing);
+  i2c_open(&eeBus, 28, 29, 0);
+  oled.displayWidth = 128;                    // Draw in memory only
+  oled.displayHeight = 64;
+  self = &oled;
+
+  print("# model,name,ticks,reps (clkfreq %d)\n", CLKFREQ);
+  bench("print", bench_print);
+  bench("sprint", bench_sprint);
+  bench("float2string", bench_float2string);
+  bench("i2c_writeByte", bench_i2c);
+  bench("shift_out", bench_shift_out);
+  bench("ee_getInt", bench_ee_getInt);
+  ee_getStr((unsigned char *) str, 12, _ActivityBot_EE_Start_);
+  if(!strcmp(str, "ActivityBot"))
+  {
+    interpolation_table_setup();
+    bench("interpolate", bench_interpolate);
+  }
+  else print("# interpolate skipped, no ActivityBot calibration\n");
+  bench("dt_fromEt", bench_dt_fromEt);
+  bench("ParseRMC", bench_nmea);
+  bench("line", bench_line);
+  print("# done\n");
+}
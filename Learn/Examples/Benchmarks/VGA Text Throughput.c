@@ -0,0 +1,54 @@
+/*
+  VGA Text Throughput.c
+
+  Measures how many characters per second the vgatext library puts on a
+  VGA display (P0 base pin), first waiting for the display's invisible
+  time before each character (vgatext_setSync(1), as the library used to
+  always do), then writing each one right away.  Prints one comma
+  separated line per run to the SimpleIDE Terminal:
+
+    bench,model,name,chars_per_second,chars
+
+  http://learn.parallax.com/propeller-c-simple-devices/vga-text-display
+*/
+
+#include "simpletools.h"                      // Include simple tools
+#include "vgatext.h"
+
+#if defined(__PROPELLER_XMMC__)
+#define MODEL "xmmc"
+#elif defined(__PROPELLER_XMM__)
+#define MODEL "xmm"
+#elif defined(__PROPELLER_CMM__)
+#define MODEL "cmm"
+#elif defined(__PROPELLER_LMM__)
+#define MODEL "lmm"
+#else
+#define MODEL "host"
+#endif
+
+vgatext *vga;
+
+void run(const char *name, int sync, int screens)
+{
+  int chars = screens * VGA_TEXT_SCREENSIZE;
+  vgatext_setSync(sync);
+  vgatext_clear();
+  int t = CNT;
+  for(int i = 0; i < chars; i++)
+  {
+    writeChar(vga, 'A' + i % 26);
+  }
+  t = CNT - t;
+  int cps = t ? (int) (chars * (float) CLKFREQ / t) : 0;
+  print("bench,%s,%s,%d,%d\n", MODEL, name, cps, chars);
+}
+
+int main()
+{
+  vga = vgatext_open(0);
+  print("# model,name,chars_per_second,chars (clkfreq %d)\n", CLKFREQ);
+  run("vgatext_sync", 1, 1);
+  run("vgatext", 0, 20);
+  print("# done\n");
+}
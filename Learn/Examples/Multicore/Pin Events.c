@@ -0,0 +1,35 @@
+/*
+  Pin Events.c
+  
+  Count presses on pushbuttons connected to P3 and P4 and display how long
+  each one was held, without a loop that keeps checking the pins.  The pin
+  events cog records every edge with a timestamp, and the main loop picks
+  them up whenever it gets around to it.
+*/
+
+#include "simpletools.h"                      // Library include
+
+pin_event_t events[16];                       // Queue for up to 15 events
+pin_events_t buttons;                         // Subscriber variable
+unsigned int pressed[32];                     // Press start times
+
+int main()                                    // Main function
+{
+  pin_events_subscribe(&buttons,              // Get events for P3 and P4
+                       (1 << 3) | (1 << 4), events, 16);
+
+  while(1)                                    // Endless loop
+  {
+    pin_event_t e;
+    pin_events_wait(&buttons, &e);            // Wait for next edge
+    if(e.edge)                                // Pressed, remember time
+    {
+      pressed[e.pin] = e.time;
+    }
+    else                                      // Released, display time
+    {
+      print("P%d held %d ms\n", e.pin, 
+            (e.time - pressed[e.pin]) / (CLKFREQ / 1000));
+    }
+  }
+}
@@ -0,0 +1,23 @@
+/*
+  Pulse Capture.c
+  
+  Measure the X and Y pulses from a Memsic 2125 accelerometer at the same 
+  time with a pulse capture cog.  The main loop reads the latest widths 
+  without waiting for pulses to finish.  Xout -> P11, Yout -> P10.
+*/
+
+#include "simpletools.h"                      // Library include
+
+int main()                                    // Main function
+{
+  pulse_capture_start((1 << 11) | (1 << 10)); // Watch P11 and P10
+
+  while(1)                                    // Endless loop
+  {
+    int x = pulse_capture_high(11);           // Latest X high time (us)
+    int y = pulse_capture_high(10);           // Latest Y high time (us)
+    print("%c x = %d, y = %d%c",              // Display widths
+          HOME, x, y, CLREOL);
+    pause(200);                               // Wait 0.2 s before repeat
+  }
+}
@@ -0,0 +1,104 @@
+/*
+  Ring Buffer Throughput.c
+  
+  Compare how fast one cog can pass values to another cog with:
+    1. A volatile global variable and a ready flag (each value waits for 
+       the other cog to pick it up).
+    2. A ring buffer, one value at a time.
+    3. A ring buffer, 16 values at a time.
+  Displays messages per second for each.
+*/
+
+#include "simpletools.h"                      // Library include
+
+#define MESSAGES 2000                         // Values to send per test
+
+void consumer();                              // Forward declaration
+
+volatile int mode;                            // Test the consumer runs
+volatile int data, ready;                     // Flag handshake variables
+volatile int received, total;                 // Consumer results
+ring r;                                       // Ring buffer
+int buf[64];                                  // Ring buffer storage
+
+void report(char *name, int ticks)            // Display one result
+{
+  int perMessage = ticks / MESSAGES;
+  print("%s: %d ticks/message, %d messages/s, sum %s\n", name, perMessage, 
+        CLKFREQ / perMessage, total == MESSAGES * (MESSAGES - 1) / 2 ? "ok" : "BAD");
+}
+
+int *start(int m)                            // Start consumer for a test
+{
+  mode = m;
+  received = 0;
+  total = 0;
+  ready = 0;
+  ring_init(&r, buf, 64);
+  return cog_run(consumer, 64);
+}
+
+int main()                                    // Main function
+{
+  int *cog, t, i;
+
+  cog = start(0);                             // Flag handshake
+  t = CNT;
+  for(i = 0; i < MESSAGES; i++)
+  {
+    while(ready);                             // Wait for consumer
+    data = i;
+    ready = 1;
+  }
+  while(received < MESSAGES);
+  report("flag", CNT - t);
+  cog_end(cog);
+
+  cog = start(1);                             // Ring buffer, one at a time
+  t = CNT;
+  for(i = 0; i < MESSAGES; i++)
+    while(!ring_put(&r, i));
+  while(received < MESSAGES);
+  report("ring", CNT - t);
+  cog_end(cog);
+
+  cog = start(1);                             // Ring buffer, batches of 16
+  int batch[16];
+  t = CNT;
+  for(i = 0; i < MESSAGES; )
+  {
+    int n = 0;
+    while(n < 16 && i + n < MESSAGES) 
+    {
+      batch[n] = i + n;
+      n++;
+    }
+    int sent = 0;
+    while(sent < n) sent += ring_putBatch(&r, batch + sent, n - sent);
+    i += n;
+  }
+  while(received < MESSAGES);
+  report("ring batch", CNT - t);
+  cog_end(cog);
+}
+
+void consumer()                               // Runs in other cog
+{
+  int values[16];
+  while(1)
+  {
+    if(mode == 0)                             // Flag handshake
+    {
+      while(!ready);
+      total += data;
+      received++;
+      ready = 0;
+    }
+    else                                      // Ring buffer
+    {
+      int n = ring_getBatch(&r, values, 16);
+      for(int i = 0; i < n; i++) total += values[i];
+      received += n;
+    }
+  }
+}
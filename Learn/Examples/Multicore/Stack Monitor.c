@@ -0,0 +1,41 @@
+/*
+  Stack Monitor.c
+  
+  Check how much of each cog's stack has been used while the application 
+  keeps running.
+*/
+
+#include "simpletools.h"                     // Library includes
+
+void myCog();                                // Function prototype
+int *cog;                                    // Cog process ID variable
+
+volatile int elements = 20;                  // Elements for cog's array
+
+int main()                                   // Main function
+{
+  stack_monitor_start();                     // Check stacks from here on
+  cog = cog_run(myCog, 128);                 // Run myCog in another cog
+  pwm_start(1000);                           // Library cogs are checked too
+  pwm_set(26, 0, 500);
+  while(1)
+  {
+    pause(2000);                             // Let cogs work
+    stack_monitor_report();                  // Display stack usage
+    print("\n");
+    if(elements < 100) elements += 10;       // Make myCog use more stack
+  }
+}
+
+void myCog()                                 // Function running in other cog
+{
+  int n = 0;                                 // Initialize counting variable
+  while(1)                                   // Function's loop
+  {
+    int size = elements;                     // Array size for this pass
+    int array[size];                         // Declare an array
+    array[n % size] = n;                     // Fill a cell
+    n++;                                     // Add 1 to n
+    pause(10);                               // Wait 10 ms before repeat
+  }
+}
@@ -0,0 +1,50 @@
+/*
+  Trace Regions.c
+  
+  Time code regions in two cogs and send the records to SimpleIDE Terminal.
+  Save the terminal output to a file, then run the tracedump program from
+  libsimpletools/tools on the computer to see a timeline and the minimum, 
+  average and maximum clock ticks for each region.
+*/
+
+#define TRACE_ON                             // Turn on TRACE_BEGIN/END
+#include "simpletools.h"                     // Library includes
+
+#define ID_MAIN   1                          // Region IDs
+#define ID_MATH   2
+#define ID_BLINK  3
+
+void blinker();                              // Function prototype
+
+volatile int n = 100;
+
+int main()                                   // Main function
+{
+  trace_name(ID_MAIN, "main loop");          // Names for the timeline
+  trace_name(ID_MATH, "math");
+  trace_name(ID_BLINK, "blink");
+  cog_run(blinker, 128);                     // Start blinker cog
+
+  while(1)
+  {
+    TRACE_BEGIN(ID_MAIN);
+    TRACE_BEGIN(ID_MATH);                    // Nested region
+    volatile int sum = 0;
+    for(int i = 0; i < n; i++) sum += i * i;
+    TRACE_END(ID_MATH);
+    pause(10);
+    TRACE_END(ID_MAIN);
+    trace_dump(simpleterm_pointer());        // Send records so far
+  }
+}
+
+void blinker()                               // Function for other cog
+{
+  while(1)
+  {
+    TRACE_BEGIN(ID_BLINK);
+    toggle(26);                              // Toggle P26 light
+    TRACE_END(ID_BLINK);
+    pause(25);
+  }
+}
@@ -0,0 +1,69 @@
+/*
+  Worker Pool.c
+  
+  Count the prime numbers below 4000 by splitting the range into 8 jobs
+  and handing them to a pool of 4 worker cogs.  Compare with the time it 
+  takes to count them in one cog.
+*/
+
+#include "simpletools.h"                      // Library include
+
+#define JOBS 8                                // Pieces of work
+#define RANGE 500                             // Numbers per piece
+
+typedef struct                                // Job inputs and output
+{
+  int start;
+  int count;
+} primeJob;
+
+primeJob job[JOBS];                           // One per piece of work
+
+void countPrimes(void *par)                   // Job function
+{
+  primeJob *pj = (primeJob *) par;
+  int count = 0;
+  for(int n = pj->start; n < pj->start + RANGE; n++)
+  {
+    if(n < 2) continue;
+    int prime = 1;
+    for(int d = 2; d * d <= n; d++)
+    {
+      if(n % d == 0) { prime = 0; break; }
+    }
+    count += prime;
+  }
+  pj->count = count;
+}
+
+int main()                                    // Main function
+{
+  int handle[JOBS];
+  int i, total, t;
+
+  for(i = 0; i < JOBS; i++) job[i].start = i * RANGE;
+
+  t = CNT;                                    // One cog
+  total = 0;
+  for(i = 0; i < JOBS; i++)
+  {
+    countPrimes(&job[i]);
+    total += job[i].count;
+  }
+  t = CNT - t;
+  print("1 cog:  %d primes in %d ms\n", total, t / ms);
+
+  int workers = pool_start(4);                // Start pool once
+  t = CNT;
+  for(i = 0; i < JOBS; i++)                   // Hand out jobs
+    handle[i] = pool_submit(countPrimes, &job[i]);
+  total = 0;
+  for(i = 0; i < JOBS; i++)                   // Collect results
+  {
+    pool_wait(handle[i]);
+    total += job[i].count;
+  }
+  t = CNT - t;
+  print("%d cogs: %d primes in %d ms\n", workers, total, t / ms);
+  pool_stop();
+}
@@ -37,7 +37,8 @@ int adc_start(int doPin, int diPin, int clkPin, int csPin, int pattern, int* arr
   adcbox.mailbox.stidx = i;
 
   extern const unsigned int *adcACpropab_code;
-  cog = cognew(adcACpropab_code, &adcbox.mailbox) + 1;
+  cog = cog_imageStart(adcACpropab_code, cog_imageLoad(adcACpropab_code),
+                       &adcbox.mailbox) + 1;
 
   int temp;
   while(1)
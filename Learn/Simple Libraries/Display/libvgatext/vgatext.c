@@ -11,6 +11,7 @@
 #include <propeller.h>
 
 #include "simpletext.h"
+#include "simpletools.h"
 #include "vgatext.h"
 
 /*
@@ -23,14 +24,14 @@ static int dummyRx(vgatext *ptr) { return 0; }
 vgatext *vgatext_open(int basepin)
 {
   /* can't use array instead of malloc because it would go out of scope. */
-  text_t *text = (text_t*) malloc(sizeof(text_t));
+  text_t *text = (text_t*) mem_get(sizeof(text_t));
 
   text->devst = &gVgaText;
 
   text->txChar    = vgatext_putchar;  /* required for terminal to work */
   text->rxChar    = dummyRx;          /* required for terminal to work */
 
-  text->cogid[0] = vgatext_start(&gVgaText, basepin);
+  text->cogid[0] = setStopCOGID(vgatext_start(&gVgaText, basepin));
   return text;
 }
 
@@ -46,7 +47,7 @@ void vgatext_close(vgatext *device)
     device->cogid[0] = 0;
   }
 
-  free(device);
+  mem_put(device);
   device = 0;
 }
 
@@ -73,8 +74,39 @@ HUBDATA static uint32_t pasm[496];
  */
 static int col, row, flag;
 
+/*
+ * Screen row the driver shows at the top; row 0 is stored there.
+ */
+static int top;
+
+/*
+ * Rows newline scrolls, set with ESC [ top ; bottom r.
+ */
+static int scrollTop, scrollBottom = VGA_TEXT_ROWS - 1;
+
+/*
+ * ANSI escape sequence state: 0 = none, 1 = after ESC, 2 = in ESC [.
+ * Numbers between ; are collected in escArg.
+ */
+#define ESC_ARGS 4
+static int esc, escArgs, escArg[ESC_ARGS];
+static int savedCol, savedRow;
+
+/*
+ * ANSI colors black, red, green, yellow, blue, magenta, cyan and white as
+ * %%RRGGBB palette values, and the foreground (30-37) and background
+ * (40-47) last set, -1 for the default.
+ */
+static const char ansiRgb[8] = { 0x00, 0x30, 0x0C, 0x3C, 0x03, 0x33, 0x0F, 0x3F };
+static int ansiFg = -1, ansiBg = -1;
+
 static int blank = 0x220;
 
+/*
+ * Nonzero to wait for the invisible time before writing each character.
+ */
+static int charSync = 0;
+
 /*
  * This is the VGA palette.
  */
@@ -123,13 +155,17 @@ int vgatext_start(volatile vgatextdev_t* vga, int basepin)
     col   = 0; // init vars
     row   = 0;
     flag  = 0;
+    top   = 0;
+    esc   = 0;
+    scrollTop    = 0;
+    scrollBottom = VGA_TEXT_ROWS - 1;
 
     vga->status = 0;
     vga->enable = 1;
     vga->pins   = basepin | 0x7;
     vga->mode   = 0b1000;
-    vga->screen = (long) gVgaScreen;
-    vga->colors = (long) gcolors;
+    vga->screen = (int) gVgaScreen;
+    vga->colors = (int) gcolors;
     vga->ht = VGA_TEXT_COLS;
     vga->vt = VGA_TEXT_ROWS;
     vga->hx = 1;
@@ -145,6 +181,7 @@ int vgatext_start(volatile vgatextdev_t* vga, int basepin)
     vga->vs = 2;
     vga->vb = 31;
     vga->rate = 80000000 >> 2;
+    vga->top  = 0;
     vga->palette = gpalette;
       
 #if defined(__PROPELLER_USE_XMM__)
@@ -199,25 +236,232 @@ void    vgatext_setColorPalette(char* ptr)
    }        
 }
 
+/*
+ * VGA_Text setSync function turns per-character waits on or off.
+ * See header file for more details.
+ */
+void    vgatext_setSync(int on)
+{
+    charSync = on;
+}
+
+/*
+ * VGA_Text waitBlank function waits for the invisible time.
+ * See header file for more details.
+ */
+void    vgatext_waitBlank(void)
+{
+    while(gVgaText.status != VGA_TEXT_STAT_INVISIBLE)
+        ;
+}
+
+/*
+ * address of a row on screen
+ */
+static short *rowAddr(int r)
+{
+    return &gVgaScreen[(r + top) % VGA_TEXT_ROWS * VGA_TEXT_COLS];
+}
+
 /*
  * print a new line
  */
 static void newline(void)
 {
+    int r;
+
     col = 0;
-    if (++row == VGA_TEXT_ROWS) {
-        row--;
-        wordmove(&gVgaScreen[0], &gVgaScreen[VGA_TEXT_COLS], VGA_TEXT_LASTROW); // scroll
-        wordfill(&gVgaScreen[VGA_TEXT_LASTROW], blank, VGA_TEXT_COLS); // clear new line
+    if (row != scrollBottom) {
+        if (row < VGA_TEXT_ROWS - 1)
+            row++;
+    }
+    else if (scrollTop == 0 && scrollBottom == VGA_TEXT_ROWS - 1) {
+        wordfill(rowAddr(0), blank, VGA_TEXT_COLS); // clear new line
+        if (++top == VGA_TEXT_ROWS)
+            top = 0;
+        gVgaText.top = top; // scroll, the driver shows the next row first
+    }
+    else {
+        for (r = scrollTop; r < scrollBottom; r++) // scroll region
+            wordmove(rowAddr(r), rowAddr(r + 1), VGA_TEXT_COLS);
+        wordfill(rowAddr(scrollBottom), blank, VGA_TEXT_COLS);
     }
 }
 
+/*
+ * clamp a cursor position to the screen
+ */
+static int limit(int val, int max)
+{
+    return val < 0 ? 0 : val > max ? max : val;
+}
+
+/*
+ * erase part of the screen: 0 = cursor to end, 1 = start to cursor,
+ * 2 = all; rows r0 to r1 (to erase a line, r0 = r1 = row)
+ */
+static void erase(int mode, int r0, int r1)
+{
+    short val = color << 11 | blank;
+    int r;
+
+    for (r = r0; r <= r1; r++) {
+        short *p = rowAddr(r);
+        if (r == row && mode == 0)
+            wordfill(p + col, val, VGA_TEXT_COLS - col);
+        else if (r == row && mode == 1)
+            wordfill(p, val, col + 1);
+        else if ((r > row && mode == 0) || (r < row && mode == 1) || mode == 2)
+            wordfill(p, val, VGA_TEXT_COLS);
+    }
+}
+
+/*
+ * distance between two %%RRGGBB colors, channel by channel
+ */
+static int rgbDist(int a, int b)
+{
+    int d = 0, s;
+
+    for (s = 0; s < 6; s += 2)
+        d += abs((a >> s & 3) - (b >> s & 3));
+    return d;
+}
+
+/*
+ * palette color index whose foreground and background are nearest the
+ * ANSI ones set; 0 when both are the default
+ */
+static int ansiColor(void)
+{
+    int best = 0, bestDist = 99, ii, d;
+
+    if (ansiFg < 0 && ansiBg < 0)
+        return 0;
+    for (ii = 0; ii < VGA_TEXT_COLORS; ii++) {
+        d = 0;
+        if (ansiFg >= 0)
+            d += rgbDist(gcolors[ii * 2] >> 26 & 0x3F, ansiRgb[ansiFg]);
+        if (ansiBg >= 0)
+            d += rgbDist(gcolors[ii * 2] >> 18 & 0x3F, ansiRgb[ansiBg]);
+        if (d < bestDist) {
+            best = ii;
+            bestDist = d;
+        }
+    }
+    return best;
+}
+
+/*
+ * carry out ESC [ arguments final
+ */
+static void csi(int final)
+{
+    int a = escArg[0];
+    int n = a ? a : 1;
+    int ii;
+
+    switch(final)
+    {
+        case 'A':
+            row = limit(row - n, VGA_TEXT_ROWS - 1);
+            break;
+        case 'B':
+            row = limit(row + n, VGA_TEXT_ROWS - 1);
+            break;
+        case 'C':
+            col = limit(col + n, VGA_TEXT_COLS - 1);
+            break;
+        case 'D':
+            col = limit(col - n, VGA_TEXT_COLS - 1);
+            break;
+        case 'H':   // fall though
+        case 'f':
+            row = limit(n - 1, VGA_TEXT_ROWS - 1);
+            col = limit((escArg[1] ? escArg[1] : 1) - 1, VGA_TEXT_COLS - 1);
+            break;
+        case 'J':
+            erase(a, 0, VGA_TEXT_ROWS - 1);
+            break;
+        case 'K':
+            erase(a, row, row);
+            break;
+        case 'm':
+            for (ii = 0; ii <= escArgs && ii < ESC_ARGS; ii++) {
+                a = escArg[ii];
+                if (a == 0)
+                    ansiFg = ansiBg = -1;
+                else if (a == 39)
+                    ansiFg = -1;
+                else if (a == 49)
+                    ansiBg = -1;
+                else if (a >= 30 && a <= 37)
+                    ansiFg = a - 30;
+                else if (a >= 40 && a <= 47)
+                    ansiBg = a - 40;
+            }
+            color = ansiColor();
+            break;
+        case 'r':
+            n = limit(n - 1, VGA_TEXT_ROWS - 1);
+            a = escArg[1] ? limit(escArg[1] - 1, VGA_TEXT_ROWS - 1) : VGA_TEXT_ROWS - 1;
+            if (n < a) {
+                scrollTop = n;
+                scrollBottom = a;
+                col = 0;
+                row = 0;
+            }
+            break;
+        case 's':
+            savedCol = col;
+            savedRow = row;
+            break;
+        case 'u':
+            col = savedCol;
+            row = savedRow;
+            break;
+    }
+}
+
+/*
+ * take the next character of an ANSI escape sequence
+ * returns 0 if c is not part of one
+ */
+static int ansi(int c)
+{
+    if (esc == 0) {
+        if (c != 27)
+            return 0;
+        esc = 1;
+    }
+    else if (esc == 1) {
+        esc = 0;
+        if (c == '[') {
+            esc = 2;
+            escArgs = 0;
+            memset(escArg, 0, sizeof(escArg));
+        }
+    }
+    else if (c >= '0' && c <= '9') {
+        if (escArgs < ESC_ARGS)
+            escArg[escArgs] = escArg[escArgs] * 10 + c - '0';
+    }
+    else if (c == ';') {
+        escArgs++;
+    }
+    else if (c != '?') {
+        esc = 0;
+        csi(c);
+    }
+    return 1;
+}
+
 /*
  * print a character
  */
 static void printc(int c)
 {
-    int   ndx = row * VGA_TEXT_COLS + col;
+    short *ptr = rowAddr(row) + col;
     short val = 0;
     
     /* a character is represented by a palette color and character index
@@ -226,12 +470,11 @@ static void printc(int c)
     val  = ((color << 1) | (c & 1)) << 10;
     val += 0x200 + (c & 0xFE);
 
-    // Driver updates during invisible time.
-    // while(gVgaText.status != VGA_TEXT_STAT_INVISIBLE)    ;
-
-    while(gVgaText.status != VGA_TEXT_STAT_INVISIBLE)
-        ;
-    gVgaScreen[ndx] = val; // works
+    // The driver reads gVgaScreen as it draws each line, so a character
+    // written while it is visible just shows up from the next line on.
+    if (charSync)
+        vgatext_waitBlank();
+    *ptr = val;
 
     if (++col == VGA_TEXT_COLS) {
         newline();
@@ -246,6 +489,8 @@ static void printc(int c)
  */
 int vgatext_out(int c)
 {
+    if(flag == 0 && ansi(c))
+        return 0;
     if(flag == 0)
     {
         switch(c)
@@ -255,6 +500,8 @@ int vgatext_out(int c)
                 wordfill(&gVgaScreen[0], color << 11 | blank, VGA_TEXT_SCREENSIZE);
                 col = 0;
                 row = 0;
+                top = 0;
+                gVgaText.top = 0;
                 break;
             case 1:
                 col = 0;
@@ -305,6 +552,8 @@ int vgatext_out(int c)
  */
 int vgatext_putchar(vgatext *vga, int c)
 {
+    if (ansi(c))
+        return (int)c;
     switch(c)
     {
         case '\b':
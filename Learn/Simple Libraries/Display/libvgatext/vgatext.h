@@ -15,7 +15,7 @@
  * @par Memory Models
  * Use with CMM, LMM, XMM. 
  *
- * @version v0.90 
+ * @version v0.93 
  *
  * @note Currently setting individual character foreground/background
  * colors does not work. Setting a screen palette is OK with
@@ -109,27 +109,28 @@ typedef enum {
  */
 typedef struct _vga_text_struct
 {
-    long status    ; // 0/1/2 = off/visible/invisible      read-only   (21 longs)
-    long enable    ; // 0/non-0 = off/on                   write-only
-    long pins      ; // %pppttt = pins                     write-only
-    long mode      ; // %tihv = tile,interlace,hpol,vpol   write-only
-    long screen    ; // pointer to screen (words)          write-only
-    long colors    ; // pointer to colors (longs)          write-only            
-    long ht        ; // horizontal tiles                   write-only
-    long vt        ; // vertical tiles                     write-only
-    long hx        ; // horizontal tile expansion          write-only
-    long vx        ; // vertical tile expansion            write-only
-    long ho        ; // horizontal offset                  write-only
-    long vo        ; // vertical offset                    write-only
-    long hd        ; // horizontal display ticks           write-only
-    long hf        ; // horizontal front porch ticks       write-only
-    long hs        ; // horizontal sync ticks              write-only
-    long hb        ; // horizontal back porch ticks        write-only
-    long vd        ; // vertical display lines             write-only
-    long vf        ; // vertical front porch lines         write-only
-    long vs        ; // vertical sync lines                write-only
-    long vb        ; // vertical back porch lines          write-only
-    long rate      ; // tick rate (Hz)                     write-only
+    int  status    ; // 0/1/2 = off/visible/invisible      read-only   (22 longs)
+    int  enable    ; // 0/non-0 = off/on                   write-only
+    int  pins      ; // %pppttt = pins                     write-only
+    int  mode      ; // %tihv = tile,interlace,hpol,vpol   write-only
+    int  screen    ; // pointer to screen (words)          write-only
+    int  colors    ; // pointer to colors (longs)          write-only            
+    int  ht        ; // horizontal tiles                   write-only
+    int  vt        ; // vertical tiles                     write-only
+    int  hx        ; // horizontal tile expansion          write-only
+    int  vx        ; // vertical tile expansion            write-only
+    int  ho        ; // horizontal offset                  write-only
+    int  vo        ; // vertical offset                    write-only
+    int  hd        ; // horizontal display ticks           write-only
+    int  hf        ; // horizontal front porch ticks       write-only
+    int  hs        ; // horizontal sync ticks              write-only
+    int  hb        ; // horizontal back porch ticks        write-only
+    int  vd        ; // vertical display lines             write-only
+    int  vf        ; // vertical front porch lines         write-only
+    int  vs        ; // vertical sync lines                write-only
+    int  vb        ; // vertical back porch lines          write-only
+    int  rate      ; // tick rate (Hz)                     write-only
+    int  top       ; // screen row shown at top            write-only
     char *palette  ; // color palette
 } vgatextdev_t;
 
@@ -185,7 +186,8 @@ void    vgatext_close(vgatext *device);
 
 /**
  * @brief Prints a character at current cursor position or performs
- * a screen function based on the following table: 
+ * a screen function based on the following table, or takes part in an ANSI
+ * escape sequence (see vgatext_putchar): 
  *
  *    0 = clear screen @n
  *    1 = home @n
@@ -205,6 +207,23 @@ int     vgatext_out(int c);
 /**
  * @brief Print character to screen.
  *
+ * @details Understands these ANSI/VT100 escape sequences, so terminal
+ * software and dprint can move the cursor and update parts of the screen
+ * without sending each character's position.  n, r and c are decimal
+ * numbers, and rows and columns count from 1 at the top left.
+ *
+ *    ESC [ n A, B, C, D = cursor up, down, right, left n (default 1) @n
+ *    ESC [ r ; c H = cursor to row r, column c (default 1 ; 1) @n
+ *    ESC [ n J = erase to end (0), from start (1) or all (2) of screen @n
+ *    ESC [ n K = erase to end (0), from start (1) or all (2) of line @n
+ *    ESC [ n ; ... m = colors, 0 = default, 30-37 foreground, 39 default
+ *    foreground, 40-47 background, 49 default background; the palette
+ *    color index nearest both the foreground and background is used @n
+ *    ESC [ t ; b r = only scroll rows t to b, cursor home @n
+ *    ESC [ s, u = save, restore cursor position @n
+ *
+ * Other sequences are read and ignored.
+ *
  * @param *vga the device identifier
  * @param c is character to print
  */
@@ -233,6 +252,27 @@ int    vgatext_putchar(vgatext *vga, int c);
  */
 void    vgatext_setColorPalette(char* palette);
 
+/**
+ * @brief Make each character wait for the display's invisible (vertical 
+ * blanking) time before it is written to the screen.  Off by default.
+ *
+ * @details The driver cog reads the screen as it draws each line, so a 
+ * character written at any other time only changes the lines the driver
+ * has not drawn yet for one frame.  Waiting keeps text from ever being
+ * drawn half updated, but limits output to the few characters that fit in
+ * each blanking time, about 60 frames per second.  To start redrawing a
+ * whole screen at the top of a frame, call vgatext_waitBlank once before
+ * writing it instead.
+ *
+ * @param on 1 to wait before each character, 0 to write right away.
+ */
+void    vgatext_setSync(int on);
+
+/**
+ * @brief Wait for the display's invisible (vertical blanking) time.
+ */
+void    vgatext_waitBlank(void);
+
 /**
  * @brief Clear the VGA display. 
  */
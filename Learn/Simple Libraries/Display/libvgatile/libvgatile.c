@@ -0,0 +1,82 @@
+/**
+ * This is the main libvgatile program file.
+ */
+/**
+ * @file libvgatile.c
+ * VGA tile map and sprite driver test harness.
+ *
+ * Copyright (c) 2014, Parallax Inc
+ * See end of file for terms of use.
+ */
+
+#include "vgatile.h"
+
+/*
+ * A gauge needle tile and a ball sprite.
+ */
+VGA_TILE_BITMAP(needle);
+
+static const int ball[8] =
+{
+    0x000FF000,
+    0x003FFC00,
+    0x00FFFF00,
+    0x00FFFF00,
+    0x00FFFF00,
+    0x00FFFF00,
+    0x003FFC00,
+    0x000FF000
+};
+
+int main(void)
+{
+    int x = 0, dx = 2, y = 0, dy = 3, ii;
+
+    vgatile *vga = vgatile_open(8);
+
+    for(ii = 0; ii < VGA_TILE_HEIGHT; ii++)
+        vgatile_setPixel(needle, ii / 2, VGA_TILE_HEIGHT - 1 - ii, 3);
+    vgatile_setColorset(16, 0b000000, 0b000000, 0b000000, 0b111100);
+
+    vgatile_setSprite(0, x, y, 8, ball);
+
+    for(ii = 0; ; ii++) {
+        // draw the next screen while this one shows
+        dprint(vga, "%cFrame %d\n", 16, vgatile_frame());
+        vgatile_setTile(ii % VGA_TILE_COLS, 5, VGA_TILE(16, needle));
+        vgatile_swap(0);
+
+        x += dx;
+        y += dy;
+        if(x < 0 || x > VGA_TILE_COLS * VGA_TILE_WIDTH - 16) dx = -dx;
+        if(y < 0 || y > VGA_TILE_ROWS * VGA_TILE_HEIGHT - 8) dy = -dy;
+        vgatile_moveSprite(0, x, y);
+    }
+
+  return 0;
+}
+
+/*
++--------------------------------------------------------------------
+|  TERMS OF USE: MIT License
++--------------------------------------------------------------------
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files
+(the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge,
+publish, distribute, sublicense, and/or sell copies of the Software,
+and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
++------------------------------------------------------------------
+*/
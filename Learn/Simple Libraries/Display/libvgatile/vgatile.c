@@ -0,0 +1,410 @@
+/*
+ * vgatile.c
+ * VGA tile map and sprite driver interface.
+ *
+ * Copyright (c) 2014, Parallax Inc
+ * See end of file for terms of use.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <propeller.h>
+
+#include "simpletext.h"
+#include "simpletools.h"
+#include "vgatile.h"
+
+/*
+ * This is the main global vga tile control/status structure.
+ */
+HUBDATA volatile vgatiledev_t gVgaTile;
+
+static int dummyRx(vgatile *ptr) { return 0; }
+
+vgatile *vgatile_open(int basepin)
+{
+  /* can't use array instead of malloc because it would go out of scope. */
+  text_t *text = (text_t*) mem_get(sizeof(text_t));
+
+  text->devst = &gVgaTile;
+
+  text->txChar    = vgatile_putchar;  /* required for terminal to work */
+  text->rxChar    = dummyRx;          /* required for terminal to work */
+
+  text->cogid[0] = setStopCOGID(vgatile_start(&gVgaTile, basepin));
+  return text;
+}
+
+void vgatile_close(vgatile *device)
+{
+  if(!device)
+    return;
+
+  int id = device->cogid[0];
+
+  if(id > 0) {
+    cogstop(getStopCOGID(id));
+    device->cogid[0] = 0;
+  }
+
+  mem_put(device);
+}
+
+/*
+ * These are the two tile maps, the driver shows the one gVgaTile.screen
+ * points to.
+ */
+HUBDATA short gVgaTileScreen[2][VGA_TILE_SCREENSIZE];
+
+/*
+ * This is the VGA colorset area.
+ */
+HUBDATA static int gcolors[VGA_TILE_COLORSETS];
+
+/*
+ * These are the sprites the driver reads each frame.
+ */
+HUBDATA static vgaTileSprite_t gsprites[VGA_TILE_SPRITES];
+
+/*
+ * In the case of __PROPELLER_USE_XMM__ we must copy the PASM to
+ * a temporary HUB buffer for cog start. Define buffer here.
+ */
+#if defined(__PROPELLER_USE_XMM__)
+HUBDATA static uint32_t pasm[496];
+#endif
+
+/*
+ * The tile map being drawn, the same one the driver shows until the
+ * first vgatile_swap.
+ */
+static short *draw = gVgaTileScreen[0];
+
+/*
+ * These are variables to keep up with text.
+ */
+static int col, row, color;
+
+/*
+ * Character colorset pairs, the same colors as vgatext's palette.
+ */
+static const char gpalette[VGA_TILE_COLORPAIRS * 2] =
+{                           // fgRGB  bgRGB    '
+    0b111111, 0b000001,     // %%333, %%001    '0    white / dark blue
+    0b111100, 0b010100,     // %%330, %%110    '1   yellow / brown
+    0b100010, 0b000000,     // %%202, %%000    '2  magenta / black
+    0b010101, 0b111111,     // %%111, %%333    '3     grey / white
+    0b001111, 0b000101,     // %%033, %%011    '4     cyan / dark cyan
+    0b001000, 0b101110,     // %%020, %%232    '5    green / gray-green
+    0b010000, 0b110101,     // %%100, %%311    '6      red / pink
+    0b001111, 0b000001      // %%033, %%003    '7     cyan / blue
+};
+
+static void wordfill(short *dst, short val, int len);
+static void wordmove(short *dst, short *src, int len);
+
+/*
+ * VGA tile start function starts VGA on a cog
+ * See header file for more details.
+ */
+int vgatile_start(volatile vgatiledev_t* vga, int basepin)
+{
+    extern int binary_VGA_Tile_dat_start[];
+    int id = 0;
+    int ii;
+
+    col   = 0; // init vars
+    row   = 0;
+    color = 0;
+    draw  = gVgaTileScreen[0];
+    memset(gsprites, 0, sizeof(gsprites));
+
+    for(ii = 0; ii < VGA_TILE_COLORPAIRS; ii++)
+        vgatile_setColorPair(ii, gpalette[ii * 2], gpalette[ii * 2 + 1]);
+    wordfill(draw, VGA_TILE_CHAR(0, ' '), VGA_TILE_SCREENSIZE);
+
+    // 640 x 480 at 60 Hz timing with 25.175 MHz pixels scaled to 16 MHz
+    // ones, which leaves the driver time to add sprites to each tile.
+    vga->status = 0;
+    vga->enable = 1;
+    vga->pins   = basepin | 0x7;
+    vga->mode   = 0b1000;
+    vga->screen = (int) draw;
+    vga->colors = (int) gcolors;
+    vga->ht = VGA_TILE_COLS;
+    vga->vt = VGA_TILE_ROWS;
+    vga->hx = 1;
+    vga->vx = 1;
+    vga->ho = 0;
+    vga->vo = 0;
+    vga->hd = 400;
+    vga->hf = 10;
+    vga->hs = 61;
+    vga->hb = 37;
+    vga->vd = 480;
+    vga->vf = 11;
+    vga->vs = 2;
+    vga->vb = 31;
+    vga->rate = 16000000;
+    vga->sprites = (int) gsprites;
+    vga->frame = 0;
+
+#if defined(__PROPELLER_USE_XMM__)
+    /* in the case of XMM we need all PASM pointers to be in HUB memory */
+    extern int binary_VGA_Tile_dat_end[];
+    int pasmsize = ((int)binary_VGA_Tile_dat_end-(int)binary_VGA_Tile_dat_start)>>2;
+    if(pasmsize > 496)
+        pasmsize = 496;
+    memcpy(pasm, binary_VGA_Tile_dat_start, pasmsize << 2);
+    id = cognew((void*)pasm, (void*)vga);
+#else
+    id = cognew((void*)binary_VGA_Tile_dat_start, (void*)vga);
+#endif
+
+    waitcnt(CLKFREQ/5+CNT);
+
+    return id;
+}
+
+/*
+ * VGA tile stop function stops VGA cog
+ * See header file for more details.
+ */
+void    vgatile_stop(int id)
+{
+    if(id) {
+        cogstop(id);
+    }
+}
+
+/*
+ * VGA tile swap function shows the drawn map and draws on the other.
+ * See header file for more details.
+ */
+void    vgatile_swap(int copy)
+{
+    short *shown = draw;
+    int frame;
+
+    // The driver counts the frame before it reads the screen pointer, so
+    // once the count changes it has the new one.
+    gVgaTile.screen = (int) shown;
+    frame = gVgaTile.frame;
+    while(gVgaTile.frame == frame && gVgaTile.status != VGA_TILE_STAT_DISABLED)
+        ;
+
+    draw = shown == gVgaTileScreen[0] ? gVgaTileScreen[1] : gVgaTileScreen[0];
+    if(copy)
+        wordmove(draw, shown, VGA_TILE_SCREENSIZE);
+}
+
+/*
+ * VGA tile frame function gets the frame count.
+ * See header file for more details.
+ */
+int     vgatile_frame(void)
+{
+    return gVgaTile.frame;
+}
+
+/*
+ * VGA tile waitFrame function waits for the frame count to change.
+ * See header file for more details.
+ */
+void    vgatile_waitFrame(void)
+{
+    int frame = gVgaTile.frame;
+    while(gVgaTile.frame == frame && gVgaTile.status != VGA_TILE_STAT_DISABLED)
+        ;
+}
+
+/*
+ * VGA tile setColorset function sets one colorset's four colors.
+ * See header file for more details.
+ */
+void    vgatile_setColorset(int set, char c0, char c1, char c2, char c3)
+{
+    gcolors[set & (VGA_TILE_COLORSETS - 1)] =
+        (c3 & 0x3F) << 26 | (c2 & 0x3F) << 18 | (c1 & 0x3F) << 10 | (c0 & 0x3F) << 2;
+}
+
+/*
+ * VGA tile setColorPair function sets a character colorset pair.
+ * See header file for more details.
+ */
+void    vgatile_setColorPair(int pair, char fg, char bg)
+{
+    pair = (pair & (VGA_TILE_COLORPAIRS - 1)) << 1;
+    vgatile_setColorset(pair, bg, fg, bg, fg);
+    vgatile_setColorset(pair + 1, bg, bg, fg, fg);
+}
+
+void    vgatile_setColors(int pair)
+{
+    color = pair & (VGA_TILE_COLORPAIRS - 1);
+}
+
+short  *vgatile_screen(void)
+{
+    return draw;
+}
+
+void    vgatile_setTile(int x, int y, short tile)
+{
+    if(x >= 0 && x < VGA_TILE_COLS && y >= 0 && y < VGA_TILE_ROWS)
+        draw[y * VGA_TILE_COLS + x] = tile;
+}
+
+short   vgatile_getTile(int x, int y)
+{
+    if(x >= 0 && x < VGA_TILE_COLS && y >= 0 && y < VGA_TILE_ROWS)
+        return draw[y * VGA_TILE_COLS + x];
+    return 0;
+}
+
+void    vgatile_fill(short tile)
+{
+    wordfill(draw, tile, VGA_TILE_SCREENSIZE);
+    col = 0;
+    row = 0;
+}
+
+void    vgatile_setXY(int x, int y)
+{
+    col = x < 0 ? 0 : x % VGA_TILE_COLS;
+    row = y < 0 ? 0 : y % VGA_TILE_ROWS;
+}
+
+void    vgatile_setPixel(int *bitmap, int x, int y, int value)
+{
+    int shift = (x & 15) << 1;
+    bitmap[y] = (bitmap[y] & ~(3 << shift)) | (value & 3) << shift;
+}
+
+/*
+ * VGA tile setSprite function sets a sprite's position and image.
+ * See header file for more details.
+ */
+void    vgatile_setSprite(int n, int x, int y, int height, const int *image)
+{
+    volatile vgaTileSprite_t *s = &gsprites[n & (VGA_TILE_SPRITES - 1)];
+
+    s->height = 0;              // hidden while it changes
+    s->image  = (int) image;
+    s->x      = x;
+    s->y      = y;
+    s->height = image ? height : 0;
+}
+
+void    vgatile_moveSprite(int n, int x, int y)
+{
+    volatile vgaTileSprite_t *s = &gsprites[n & (VGA_TILE_SPRITES - 1)];
+
+    s->x = x;
+    s->y = y;
+}
+
+/*
+ * next line, scrolls the map being drawn up at the bottom
+ */
+static void newline(void)
+{
+    col = 0;
+    if (++row == VGA_TILE_ROWS) {
+        row--;
+        wordmove(draw, &draw[VGA_TILE_COLS], VGA_TILE_SCREENSIZE - VGA_TILE_COLS);
+        wordfill(&draw[VGA_TILE_SCREENSIZE - VGA_TILE_COLS],
+                 VGA_TILE_CHAR(color, ' '), VGA_TILE_COLS);
+    }
+}
+
+/*
+ * print a character
+ */
+static void printc(int c)
+{
+    draw[row * VGA_TILE_COLS + col] = VGA_TILE_CHAR(color, c);
+
+    if (++col == VGA_TILE_COLS) {
+        newline();
+    }
+}
+
+/*
+ * VGA tile putchar prints a char to the tile map with normal stdio
+ * definitions.
+ * See header file for more details.
+ */
+int vgatile_putchar(vgatile *vga, int c)
+{
+    switch(c)
+    {
+        case '\b':
+            if (col)
+                col--;
+            break;
+        case '\t':
+            do {
+                printc(' ');
+            } while(col & 7);
+            break;
+        case '\n':
+            newline();
+            break;
+        case '\r':
+            col = 0;
+            break;
+        case 16:
+            vgatile_fill(VGA_TILE_CHAR(color, ' '));
+            break;
+        case 1:
+            col = 0;
+            row = 0;
+            break;
+        default:
+            printc(c);
+            break;
+    }
+    return (int)c;
+}
+
+static void wordfill(short *dst, short val, int len)
+{
+    while(--len > -1) {
+        *dst = val;
+        dst++;
+    }
+}
+
+static void wordmove(short *dst, short *src, int len)
+{
+    while(--len > -1) {
+        *dst = *src;
+        dst++;
+        src++;
+    }
+}
+
+/*
++--------------------------------------------------------------------
+|  TERMS OF USE: MIT License
++--------------------------------------------------------------------
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files
+(the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge,
+publish, distribute, sublicense, and/or sell copies of the Software,
+and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
++------------------------------------------------------------------
+*/
@@ -0,0 +1,351 @@
+/**
+ * @file vgatile.h
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax Inc. 2014. All Rights MIT Licensed, see end of file.
+ *
+ * @brief VGA tile map and sprite driver interface.
+ *
+ * @details The screen is a map of 25 x 15 tiles, each 16 x 32 pixels.  A
+ * tile is either a character from the Propeller's ROM font or a bitmap of
+ * 2-bit pixels in hub RAM, and is drawn with the four colors of one of 32
+ * colorsets.  Four 16 pixel wide sprites are drawn over the tiles by the
+ * driver cog, line by line, so moving one does not touch the tile map.
+ *
+ * There are two tile maps.  Drawing goes to one while the driver shows
+ * the other, and vgatile_swap shows the finished one between frames, so
+ * a dashboard can redraw gauges without the screen ever showing them half
+ * drawn.  Until the first vgatile_swap, drawing shows right away, like
+ * vgatext.  The driver counts frames (vgatile_frame), so code can also
+ * just wait for the end of a frame to change things.
+ *
+ * @par Core Usage
+ * A call to vgatile_open will launch 1 additional core that supplies
+ * signaling necessary for displaying tiles and sprites with a VGA display.
+ *
+ * @par Memory Models
+ * Use with CMM, LMM, XMM.
+ *
+ * @version v0.90
+ *
+ * @par Help Improve this Library
+ * Please submit bug reports, suggestions, and improvements to this code to
+ * editor@parallax.com.
+ */
+
+#ifndef __VGATILE_H
+#define __VGATILE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "simpletext.h"
+
+/*
+ * This defines vgatile as a type alias to text_t
+ */
+typedef text_t vgatile;
+
+/**
+ * Column count
+ */
+#define  VGA_TILE_COLS 25
+
+/**
+ * Row count
+ */
+#define  VGA_TILE_ROWS 15
+
+/**
+ * Screen size count
+ */
+#define  VGA_TILE_SCREENSIZE (VGA_TILE_COLS * VGA_TILE_ROWS)
+
+/**
+ * Tile size in pixels
+ */
+#define  VGA_TILE_WIDTH  16
+#define  VGA_TILE_HEIGHT 32
+
+/**
+ * Colorset count.  Characters use colorset pairs, 2 * pair for even
+ * characters and 2 * pair + 1 for odd ones, see vgatile_setColorPair.
+ */
+#define  VGA_TILE_COLORSETS 32
+#define  VGA_TILE_COLORPAIRS 8
+
+/**
+ * Sprite count
+ */
+#define  VGA_TILE_SPRITES 4
+
+/**
+ * @brief Tile map entry that shows a bitmap with a colorset.
+ * @param colorset 0 to 31.
+ * @param bitmap Address of 32 ints, one per row of 16 2-bit pixels with
+ * the leftmost pixel in the low bits, 64-byte aligned.  Declare bitmaps
+ * with VGA_TILE_BITMAP.
+ */
+#define  VGA_TILE(colorset, bitmap) \
+         ((short) ((colorset) << 10 | ((int) (bitmap) >> 6 & 0x3FF)))
+
+/**
+ * @brief Tile map entry that shows a ROM font character with a colorset
+ * pair.
+ * @param pair 0 to 7.
+ * @param c Character 0 to 255.
+ */
+#define  VGA_TILE_CHAR(pair, c) \
+         ((short) ((((pair) << 1 | ((c) & 1)) << 10) + 0x200 + ((c) & 0xFE)))
+
+/**
+ * @brief Declare a tile bitmap, 32 rows of 16 2-bit pixels.
+ */
+#define  VGA_TILE_BITMAP(name) \
+         HUBDATA int name[VGA_TILE_HEIGHT] __attribute__((aligned(64)))
+
+/**
+ * Status enumeration
+ */
+typedef enum {
+    VGA_TILE_STAT_DISABLED,
+    VGA_TILE_STAT_INVISIBLE,
+    VGA_TILE_STAT_VISIBLE
+} vgaTileStat_t;
+
+/**
+ * Sprite, read by the driver once per frame
+ */
+typedef struct _vga_tile_sprite_struct
+{
+    int  x         ; // left pixel, may be off screen
+    int  y         ; // top pixel row, may be off screen
+    int  height    ; // pixel rows, 0 for no sprite
+    int  image     ; // pointer to height rows of 16 2-bit pixels
+} vgaTileSprite_t;
+
+/**
+ * Control structure
+ */
+typedef struct _vga_tile_struct
+{
+    int  status    ; // 0/1/2 = off/visible/invisible      read-only   (23 longs)
+    int  enable    ; // 0/non-0 = off/on                   write-only
+    int  pins      ; // %pppttt = pins                     write-only
+    int  mode      ; // %tihv = tile,interlace,hpol,vpol   write-only
+    int  screen    ; // pointer to screen (words)          write-only
+    int  colors    ; // pointer to colors (longs)          write-only
+    int  ht        ; // horizontal tiles                   write-only
+    int  vt        ; // vertical tiles                     write-only
+    int  hx        ; // horizontal tile expansion          write-only
+    int  vx        ; // vertical tile expansion            write-only
+    int  ho        ; // horizontal offset                  write-only
+    int  vo        ; // vertical offset                    write-only
+    int  hd        ; // horizontal display ticks           write-only
+    int  hf        ; // horizontal front porch ticks       write-only
+    int  hs        ; // horizontal sync ticks              write-only
+    int  hb        ; // horizontal back porch ticks        write-only
+    int  vd        ; // vertical display lines             write-only
+    int  vf        ; // vertical front porch lines         write-only
+    int  vs        ; // vertical sync lines                write-only
+    int  vb        ; // vertical back porch lines          write-only
+    int  rate      ; // tick rate (Hz)                     write-only
+    int  sprites   ; // pointer to sprites (longs)         write-only
+    int  frame     ; // frames started                     read-only
+} vgatiledev_t;
+
+/*
+ * Starts VGA tiles on a cog
+ * @param basepin is first pin number (out of 8) connected to VGA
+ * @returns non-zero cogid on success
+ */
+int     vgatile_start(volatile vgatiledev_t* vga, int basepin);
+
+/*
+ * Stops VGA tiles cog
+ * @param id is cog id returned from start function.
+ */
+void    vgatile_stop(int id);
+
+/*
+ * VGA tile public API
+ */
+
+/**
+ * @brief Open a VGA tile display.  This function launches VGA driver
+ * code into the next available cog.
+ * @param basepin can be 0, 8, 16, or 24, which correspond to base pins of
+ * P0, P8, or P16 or P24.  The pins are connected the same way as for
+ * vgatext_open.
+ * @returns vgatile identifier.  It's the address that gets copied to a
+ * pointer variable, which is passed as an identifier to simpletext functions
+ * with text_t *dev parameters and/or vgatile functions with vgatile *vga
+ * parameters.
+ */
+vgatile *vgatile_open(int basepin);
+
+/**
+ * @brief Close VGA tile display, stop and recover cog running
+ * VGA code and memory that was allocated.
+ * @param *device value that was returned by vgatile_open.
+ */
+void    vgatile_close(vgatile *device);
+
+/**
+ * @brief Print character to the tile map being drawn, with the current
+ * colorset pair.  Understands \\b, \\t, \\n, \\r, 1 (home) and 16 (clear),
+ * and scrolls the map up past the last row.
+ * @param *vga the device identifier
+ * @param c is character to print
+ */
+int     vgatile_putchar(vgatile *vga, int c);
+
+/**
+ * @brief Get the tile map being drawn, VGA_TILE_COLS entries per row.
+ *
+ * @returns address of VGA_TILE_SCREENSIZE tile map entries.
+ */
+short  *vgatile_screen(void);
+
+/**
+ * @brief Set a tile in the map being drawn.
+ * @param x columns from left.
+ * @param y rows from top.
+ * @param tile made with VGA_TILE or VGA_TILE_CHAR.
+ */
+void    vgatile_setTile(int x, int y, short tile);
+
+/**
+ * @brief Get a tile from the map being drawn.
+ * @param x columns from left.
+ * @param y rows from top.
+ * @returns the tile map entry.
+ */
+short   vgatile_getTile(int x, int y);
+
+/**
+ * @brief Fill the map being drawn with one tile, and send the cursor home.
+ * @param tile made with VGA_TILE or VGA_TILE_CHAR.
+ */
+void    vgatile_fill(short tile);
+
+/**
+ * @brief Show the tile map that has been drawn, from the next frame on,
+ * and start drawing on the other one.  Waits for the driver to take the
+ * new map, at most one frame.
+ * @param copy 1 to copy the map just shown into the one drawn next, to
+ * keep changing it a little at a time, 0 to redraw it all.
+ */
+void    vgatile_swap(int copy);
+
+/**
+ * @brief Get the number of frames the driver has started.  It changes
+ * in the invisible (vertical blanking) time after each frame is shown.
+ * @returns frame count.
+ */
+int     vgatile_frame(void);
+
+/**
+ * @brief Wait for the driver to finish showing the current frame.
+ */
+void    vgatile_waitFrame(void);
+
+/**
+ * @brief Set a colorset's four colors.  Each color is a byte with values
+ * of r, g, and b that can range from 0 to 3, packed (r << 4) | (g << 2) | b.
+ * @param set 0 to 31.
+ * @param c0 color of 0 pixels.  Colorset 0's c0 is also the border color.
+ * @param c1 color of 1 pixels.
+ * @param c2 color of 2 pixels.
+ * @param c3 color of 3 pixels, also the color of sprite pixels that are 3.
+ */
+void    vgatile_setColorset(int set, char c0, char c1, char c2, char c3);
+
+/**
+ * @brief Set the foreground and background colors of the characters drawn
+ * with a colorset pair.  Sets colorsets 2 * pair and 2 * pair + 1.
+ * @param pair 0 to 7.
+ * @param fg foreground color, packed as for vgatile_setColorset.
+ * @param bg background color.
+ */
+void    vgatile_setColorPair(int pair, char fg, char bg);
+
+/**
+ * @brief Set the colorset pair vgatile_putchar uses.
+ * @param pair 0 to 7.  Pairs start out with the same colors as vgatext's
+ * color indices.
+ */
+void    vgatile_setColors(int pair);
+
+/**
+ * @brief Set cursor position for vgatile_putchar.
+ * @param x columns from left.
+ * @param y rows from top.
+ */
+void    vgatile_setXY(int x, int y);
+
+/**
+ * @brief Set one pixel in a tile or sprite bitmap.
+ * @param bitmap rows of 16 2-bit pixels.
+ * @param x 0 to 15, pixels from left.
+ * @param y pixel rows from top.
+ * @param value 0 to 3.
+ */
+void    vgatile_setPixel(int *bitmap, int x, int y, int value);
+
+/**
+ * @brief Set a sprite.  Sprites are 16 pixels wide, any height, and
+ * drawn over the tiles.  A sprite pixel's bits are OR-ed onto the tile's
+ * pixel under it, so 0 lets the tile show through, and 3 shows the tile
+ * colorset's c3.
+ * @param n sprite 0 to 3.
+ * @param x left pixel, can be off screen.
+ * @param y top pixel row, can be off screen.
+ * @param height rows in image, 0 to hide the sprite.
+ * @param image rows of 16 2-bit pixels with the leftmost pixel in the low
+ * bits, like a tile bitmap.  The driver reads it while drawing, so it has
+ * to stay in memory.
+ */
+void    vgatile_setSprite(int n, int x, int y, int height, const int *image);
+
+/**
+ * @brief Move a sprite, from the next frame on.
+ * @param n sprite 0 to 3.
+ * @param x left pixel.
+ * @param y top pixel row.
+ */
+void    vgatile_moveSprite(int n, int x, int y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+//__VGATILE_H
+
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,81 @@
+/**
+ * @file apa102.c
+ *
+ * @author Parallax Inc.
+ *
+ * @version 0.85
+ *
+ * @copyright
+ * Copyright (c) Parallax Inc. 2014, All Rights MIT Licensed.
+ *
+ * @brief Driver for APA102 and SK9822 RGB LEDs, with the WS2812 requests.
+ */
+
+#include <propeller.h>
+#include "simpletools.h"
+#include "ws2812.h"
+
+// driver header structure
+typedef struct {
+    uint32_t    jmp_inst;
+    uint32_t    clkmask;
+    uint32_t    period;
+    uint32_t    slots;
+    uint32_t    brightptr;
+} apa102_hdr;
+
+int apa102_start(ws2812_t *state, int clkpin, int hz)
+{
+    extern uint32_t binary_apa102_driver_dat_start[];
+    apa102_hdr *hdr = cog_imageLoad(binary_apa102_driver_dat_start);
+    uint32_t period = hz > 0 ? CLKFREQ / hz : 0;
+
+    if (!hdr)
+        return -1;
+    if (period < 32)                    // too short to time, so flat out
+        period = 0;
+
+    hdr->clkmask   = 1 << clkpin;
+    hdr->period    = period;
+    hdr->slots     = (uint32_t)state->slots;
+    hdr->brightptr = (uint32_t)&state->brightness;
+
+    state->levels     = NULL;           // the chips do their own brightness
+    state->gamma      = 10;
+    state->brightness = 255;
+    mailbox_init(&state->box, state->slots, WS2812_QUEUE);
+    state->cog = cog_imageStart(binary_apa102_driver_dat_start, hdr, &state->box);
+
+    return state->cog;
+}
+
+void apa102_brightness(ws2812_t *state, int brightness)
+{
+    if (brightness < 0)
+        brightness = 0;
+    if (brightness > 31)
+        brightness = 31;
+    state->brightness = brightness << 3;    // the driver sends the top 5 bits
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -12,6 +12,7 @@
  */
 
 #include <propeller.h>
+#include "simpletools.h"
 #include "ws2812.h"
 
 // driver header structure
@@ -23,6 +24,8 @@ typedef struct {
     uint32_t    bit1hi;
     uint32_t    bit1lo;
     uint32_t    swaprg;
+    uint32_t    slots;
+    uint32_t    tableptr;
 } ws2812_hdr;
 
 // -- usreset is reset timing (us)
@@ -34,9 +37,11 @@ typedef struct {
 int ws_start(ws2812_t *state, int usreset, int ns0h, int ns0l, int ns1h, int ns1l, int type)
 {
     extern uint32_t binary_ws2812_driver_dat_start[];
-    ws2812_hdr *hdr = (ws2812_hdr *)binary_ws2812_driver_dat_start;
+    ws2812_hdr *hdr = cog_imageLoad(binary_ws2812_driver_dat_start);
     uint32_t ustix;
     
+    if (!hdr)
+        return -1;
     ustix = CLKFREQ / 1000000;          // ticks in 1us
 
     hdr->resettix = ustix * usreset;
@@ -45,22 +50,49 @@ int ws_start(ws2812_t *state, int usreset, int ns0h, int ns0l, int ns1h, int ns1
     hdr->bit1hi   = ustix * ns1h / 1000;
     hdr->bit1lo   = ustix * ns1l / 1000;
     hdr->swaprg   = (type == TYPE_GRB);
+    hdr->slots    = (uint32_t)state->slots;
+    hdr->tableptr = (uint32_t)&state->levels;
     
-    state->command = 0;
-    state->cog = cognew(hdr, &state->command);
+    state->levels     = NULL;           // no gamma table until ws2812_gamma
+    state->gamma      = 10;
+    state->brightness = 255;
+    mailbox_init(&state->box, state->slots, WS2812_QUEUE);
+    state->cog = cog_imageStart(binary_ws2812_driver_dat_start, hdr, &state->box);
     
     return state->cog;
 }
 
-void ws2812_set(ws2812_t *state, int pin, uint32_t *colors, int count)
+unsigned int ws2812_set(ws2812_t *state, int pin, uint32_t *colors, int count)
 {
     uint32_t cmd;
     cmd =  pin
         | ((count - 1) << 8)
         | ((uint32_t)colors << 16);
-    while (state->command)
-        ;
-    state->command = cmd;
+    return mailbox_post(&state->box, cmd);
+}
+
+unsigned int ws2812_set_parallel(ws2812_t *state, int pin, int strips, uint32_t *colors, int count)
+{
+    uint32_t cmd;
+    cmd =  (pin & 0x1F)
+        | ((strips - 1) << 5)
+        | ((count - 1) << 8)
+        | ((uint32_t)colors << 16);
+    return mailbox_post(&state->box, cmd);
+}
+
+unsigned int ws2812_send(ws2812_t *state, ws2812_cmd_t *cmd)
+{
+    // bit 16 marks an address, since colors addresses are long aligned
+    return mailbox_post(&state->box, ((uint32_t)cmd << 16) | 0x10000);
+}
+
+void ws2812_wait(ws2812_t *state, unsigned int id)
+{
+    if (id)
+        mailbox_wait(&state->box, id);
+    else
+        mailbox_sync(&state->box);
 }
 
 /**
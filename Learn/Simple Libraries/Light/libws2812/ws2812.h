@@ -15,6 +15,7 @@
 #define __WS2812_H__
 
 #include <stdint.h>
+#include "simpletools.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -49,15 +50,81 @@ extern "C" {
 #define COLOR_CRIMSON    0xDC283C
 #define COLOR_PURPLE     0x8C00FF
 
+#define WS2812_QUEUE        4   // ws2812_set requests the driver can hold
+#define WS2812_STRIPS       8   // chains ws2812_set_parallel can send at once
+
 // driver state structure
 typedef struct {
-    volatile uint32_t command;
+    mailbox_t box;
+    mailbox_slot_t slots[WS2812_QUEUE];
     int cog;
+    uint16_t *levels;           // gamma and brightness table, see ws2812_gamma
+    int gamma;
+    int brightness;
 } ws2812_t;
 
 // simpler type name for use with SimpleIDE
 typedef ws2812_t ws2812;
 
+// request for any number of LEDs, see ws2812_send (the driver reads it, so
+// keep the fields in this order)
+typedef struct {
+    int count;                  // LEDs in each chain, 0 sends nothing
+    int pin;                    // pin connected to the first chain
+    int strips;                 // chains on adjacent pins, kept to 1 to WS2812_STRIPS
+    int flags;                  // none yet, set to 0
+    uint32_t *colors;           // count colors for each chain
+} ws2812_cmd_t;
+
+// double-buffered frames for one chain of LEDs, see ws2812_frame_init
+typedef struct {
+    ws2812_t *driver;
+    ws2812_cmd_t cmd;           // request sending the front buffer
+    uint32_t *front;            // being sent, or sent last
+    uint32_t *back;             // being drawn
+    unsigned int id;            // ID of cmd's request
+    int held;                   // back buffer committed, not sent yet
+    unsigned int frames;        // frames sent
+    unsigned int dropped;       // frames replaced before they could be sent
+} ws2812_frame_t;
+
+// effects for ws2812_anim_post
+#define WS2812_FILL         0   // every LED color
+#define WS2812_FADE         1   // color to color2 and back, period frames each way
+#define WS2812_CHASE        2   // size LEDs of color, size of color2, moving
+                                //   along a LED every period frames
+#define WS2812_RAINBOW      3   // color wheel along the chain, turning once
+                                //   every period frames
+#define WS2812_SPARKLE      4   // size random LEDs of color each frame, the
+                                //   rest color2; the same seed, the same LEDs
+
+// an effect for the animation engine
+typedef struct {
+    int effect;                 // WS2812_FILL, WS2812_FADE, ...
+    uint32_t color;
+    uint32_t color2;
+    int period;                 // in frames
+    int size;                   // in LEDs
+    unsigned int seed;
+} ws2812_effect_t;
+
+#define WS2812_ANIM_QUEUE   2   // effects ws2812_anim_post can queue
+
+// animation engine state, see ws2812_anim_start
+typedef struct {
+    ws2812_frame_t frame;
+    mailbox_t box;              // posted effects
+    mailbox_slot_t slots[WS2812_ANIM_QUEUE];
+    ws2812_effect_t posted[WS2812_ANIM_QUEUE];
+    ws2812_effect_t effect;     // effect being shown
+    unsigned int ticks;         // clock ticks for each frame
+    unsigned int step;          // frames since the effect started
+    unsigned int random;
+    volatile int stopping;
+    int cog;
+    unsigned int stack[44 + 64];
+} ws2812_anim_t;
+
 /**
  * @brief Open a driver for WS2812 chips
  * 
@@ -108,6 +175,35 @@ int ws2812b_start(ws2812_t *driver);
  */
 int ws_start(ws2812_t *driver, int usreset, int ns0h, int ns0l, int ns1h, int ns1l, int type);
 
+/**
+ * @brief Start a driver for APA102 or SK9822 chips, which have a clock pin
+ * as well as a data pin
+ *
+ * @details The driver takes the same requests as the WS2812 drivers, with
+ * pin being the data pin.  The clock pin runs for every request, so wire
+ * it to one chain only, and send that driver requests for that chain's data
+ * pin.  For more chains, start a driver for each, with its own clock pin.
+ * Parallel strips, ws2812_gamma tables and TYPE_RGB/TYPE_GRB do not apply:
+ * colors go out as the chips' blue, green, red, after a 5-bit global
+ * brightness (see apa102_brightness).
+ *
+ * @param driver Pointer to a driver structure
+ * @param clkpin Pin connected to the chain's clock input
+ * @param hz Clock rate, or 0 for as fast as the driver can go (CLKFREQ/24,
+ * about 3.3 MHz at 80 MHz).  Rates above CLKFREQ/32 also run flat out.
+ * @returns Driver COG number or -1 on failure
+ */
+int apa102_start(ws2812_t *driver, int clkpin, int hz);
+
+/**
+ * @brief Set the global brightness an APA102 or SK9822 driver sends with
+ * every LED
+ *
+ * @param driver Pointer to the driver structure
+ * @param brightness 0 (off) to 31 (full, the default)
+ */
+void apa102_brightness(ws2812_t *driver, int brightness);
+
 /**
  * @brief Shut down the COG running a driver
  *
@@ -118,12 +214,189 @@ void ws2812_stop(ws2812_t *driver);
 /**
  * @brief Set color pattern on a chain of LEDs
  *
+ * @details Returns as soon as the request is queued, so calls for several
+ * chains (or frames) can be made back to back.  The driver reads colors
+ * while it sends them, so leave the array alone until ws2812_wait says the
+ * request is finished.
+ *
  * @param driver Pointer to the driver structure
  * @param pin Pin connected to the first LED
  * @param colors Array of colors, one for each LED in the chain
+ * @param count Number of LEDs in the chain, up to 256 (see ws2812_send)
+ * @returns Request ID for ws2812_wait
+ */
+unsigned int ws2812_set(ws2812_t *driver, int pin, uint32_t *colors, int count);
+
+/**
+ * @brief Set color patterns on several chains of LEDs at once
+ *
+ * @details The chains are on adjacent pins, starting with pin, and the
+ * driver sends the same bit to all of them together.  Bits take longer
+ * than they do for one chain (up to about twice as long with 8 chains), but
+ * every chain gets its frame in that time.  Colors holds count colors for
+ * the first chain, then count for the second, and so on.  Like ws2812_set,
+ * this returns as soon as the request is queued.
+ *
+ * @param driver Pointer to the driver structure
+ * @param pin Pin connected to the first LED of the first chain
+ * @param strips Number of chains (1 to WS2812_STRIPS)
+ * @param colors Array of colors, count for each chain
+ * @param count Number of LEDs in each chain, up to 256 (see ws2812_send)
+ * @returns Request ID for ws2812_wait
+ */
+unsigned int ws2812_set_parallel(ws2812_t *driver, int pin, int strips, uint32_t *colors, int count);
+
+/**
+ * @brief Set color patterns on chains of any length
+ *
+ * @details ws2812_set and ws2812_set_parallel pack their request into one
+ * long, which leaves room for 256 LEDs.  This passes the address of a
+ * request instead, so a chain can be thousands of LEDs long and still go
+ * out as one frame.  The driver reads the request when it gets to it, so
+ * leave it and the colors alone until ws2812_wait says it is finished.
+ *
+ * @param driver Pointer to the driver structure
+ * @param cmd Pointer to the request
+ * @returns Request ID for ws2812_wait
+ */
+unsigned int ws2812_send(ws2812_t *driver, ws2812_cmd_t *cmd);
+
+/**
+ * @brief Wait for the driver to finish sending colors to a chain of LEDs
+ *
+ * @param driver Pointer to the driver structure
+ * @param id Request ID from ws2812_set, or 0 to wait for all of them
+ */
+void ws2812_wait(ws2812_t *driver, unsigned int id);
+
+/**
+ * @brief Have the driver correct colors for gamma and brightness
+ *
+ * @details LEDs look much brighter at low levels than their numbers say,
+ * and dimming colors in the program (with COLORX or ws2812_wheel_dim)
+ * takes time for every LED and loses the dimmest steps.  Given a table,
+ * the driver looks up each red, green and blue value on its way out
+ * instead.  The table holds levels with 8 fraction bits, and the driver
+ * dithers the fractions over 8 frames, so dimmed colors keep their steps
+ * as long as frames keep coming.  Each LED takes about 2 us longer to
+ * send.  Applies to requests for one chain; parallel chains get their
+ * colors as they are.
+ *
+ * @param driver Pointer to the driver structure, after starting it
+ * @param levels Array of 256 for the table, or NULL to send colors as they
+ * are
+ * @param gamma Gamma in tenths, from 10 (none) to 30; 22 suits most LEDs
+ */
+void ws2812_gamma(ws2812_t *driver, uint16_t *levels, int gamma);
+
+/**
+ * @brief Set the brightness of everything the driver sends, once a table
+ * is set up with ws2812_gamma
+ *
+ * @param driver Pointer to the driver structure
+ * @param brightness 0 (off) to 255 (full, the default)
+ */
+void ws2812_brightness(ws2812_t *driver, int brightness);
+
+/**
+ * @brief Set up double-buffered frames for a chain of LEDs
+ *
+ * @details Draw each frame into the array ws2812_begin_frame returns,
+ * then ws2812_commit it.  Neither call waits for the LEDs: the driver
+ * sends one buffer while the program draws into the other, and a committed
+ * frame goes out as soon as the one before it is done.  If the program
+ * draws faster than the chain can take frames, a committed frame that is
+ * still waiting when the next one begins is dropped, so the LEDs always
+ * get the newest one.  frame->frames counts frames sent and
+ * frame->dropped frames dropped.
+ *
+ * Nothing sends a waiting frame in the background: the next
+ * ws2812_begin_frame, ws2812_commit or ws2812_flush call that finds the
+ * driver done sends it.  So if a frame takes less time to draw than to
+ * send, the chain sits idle from the end of each frame until the next of
+ * those calls, and that call usually drops the waiting frame instead.  To
+ * send every frame, pace the drawing to the chain or call ws2812_flush
+ * before ws2812_begin_frame.
+ *
+ * @param frame Pointer to a frame structure
+ * @param driver Pointer to the driver structure
+ * @param pin Pin connected to the first LED
+ * @param front Array of count colors
+ * @param back Another array of count colors
  * @param count Number of LEDs in the chain
  */
-void ws2812_set(ws2812_t *driver, int pin, uint32_t *colors, int count);
+void ws2812_frame_init(ws2812_frame_t *frame, ws2812_t *driver, int pin,
+                       uint32_t *front, uint32_t *back, int count);
+
+/**
+ * @brief Start drawing a frame
+ *
+ * @details The array holds the frame before last, or the last one if it
+ * was dropped, so set every LED.
+ *
+ * @param frame Pointer to the frame structure
+ * @returns Array of colors to draw the frame into
+ */
+uint32_t *ws2812_begin_frame(ws2812_frame_t *frame);
+
+/**
+ * @brief Send the frame drawn since ws2812_begin_frame
+ *
+ * @details If the driver is still sending the last frame, this one waits
+ * for the next ws2812_begin_frame, ws2812_commit or ws2812_flush call to
+ * go out, so keep calling them, or call ws2812_flush after the last frame.
+ *
+ * @param frame Pointer to the frame structure
+ * @returns 1 if the frame was sent, 0 if it is waiting
+ */
+int ws2812_commit(ws2812_frame_t *frame);
+
+/**
+ * @brief Wait for any committed frame to be sent and finished
+ *
+ * @param frame Pointer to the frame structure
+ */
+void ws2812_flush(ws2812_frame_t *frame);
+
+/**
+ * @brief Start an animation engine for a chain of LEDs in another cog
+ *
+ * @details The engine draws an effect into double-buffered frames (see
+ * ws2812_frame_init) at a steady frame rate, so the program only has to
+ * post a new effect when it wants a change.  The engine posts the frames,
+ * so leave the driver to it until ws2812_anim_stop.  Until the first
+ * ws2812_anim_post it sends black.
+ *
+ * @param anim Pointer to an animation engine structure
+ * @param driver Pointer to the driver structure
+ * @param pin Pin connected to the first LED
+ * @param front Array of count colors
+ * @param back Another array of count colors
+ * @param count Number of LEDs in the chain, 1 or more
+ * @param fps Frames per second, 1 or more
+ * @returns Engine COG number or -1 on failure
+ */
+int ws2812_anim_start(ws2812_anim_t *anim, ws2812_t *driver, int pin,
+                      uint32_t *front, uint32_t *back, int count, int fps);
+
+/**
+ * @brief Change the effect an animation engine shows
+ *
+ * @details The engine starts the effect at its next frame.  This copies
+ * the effect, so it can be changed or reused right away.
+ *
+ * @param anim Pointer to the animation engine structure
+ * @param effect Pointer to the effect
+ * @returns ID for mailbox_done(&anim->box, id) and mailbox_wait
+ */
+unsigned int ws2812_anim_post(ws2812_anim_t *anim, ws2812_effect_t *effect);
+
+/**
+ * @brief Stop an animation engine once its last frame is sent
+ *
+ * @param anim Pointer to the animation engine structure
+ */
+void ws2812_anim_stop(ws2812_anim_t *anim);
 
 /**
  * @brief Create color from a 0 to 255 position input
@@ -0,0 +1,164 @@
+/**
+ * @file ws2812_anim.c
+ *
+ * @author Parallax Inc.
+ *
+ * @version 0.85
+ *
+ * @copyright
+ * Copyright (c) Parallax Inc. 2014, All Rights MIT Licensed.
+ *
+ * @brief Animation engine for a chain of WS2812 LEDs, in its own cog.
+ */
+
+#include "ws2812.h"
+
+// a + (b - a) * num / den for each of red, green and blue
+static uint32_t mix(uint32_t a, uint32_t b, int num, int den)
+{
+    uint32_t color = 0;
+    int shift, x, y;
+
+    for (shift = 0; shift < 24; shift += 8) {
+        x = (a >> shift) & 0xFF;
+        y = (b >> shift) & 0xFF;
+        color |= (uint32_t)(x + (y - x) * num / den) << shift;
+    }
+    return color;
+}
+
+static void render(ws2812_anim_t *anim, uint32_t *leds)
+{
+    ws2812_effect_t *e = &anim->effect;
+    int count = anim->frame.cmd.count;
+    int period = e->period > 0 ? e->period : 1;
+    int size = e->size > 0 ? e->size : 1;
+    int i, at;
+    uint32_t color;
+
+    switch (e->effect) {
+    case WS2812_FADE:
+        at = anim->step % (2 * period);
+        if (at > period)
+            at = 2 * period - at;
+        color = mix(e->color, e->color2, at, period);
+        for (i = 0; i < count; i++)
+            leds[i] = color;
+        break;
+    case WS2812_CHASE:
+        at = 2 * size - anim->step / period % (2 * size);
+        for (i = 0; i < count; i++)
+            leds[i] = (i + at) % (2 * size) < size ? e->color : e->color2;
+        break;
+    case WS2812_RAINBOW:
+        at = anim->step % period * 256 / period;
+        for (i = 0; i < count; i++)
+            leds[i] = ws2812_wheel((i * 256 / count + at) & 255);
+        break;
+    case WS2812_SPARKLE:
+        for (i = 0; i < count; i++)
+            leds[i] = e->color2;
+        for (i = 0; i < size; i++) {
+            anim->random = anim->random * 1103515245 + 12345;
+            leds[(anim->random >> 16) % count] = e->color;
+        }
+        break;
+    default:
+        for (i = 0; i < count; i++)
+            leds[i] = e->color;
+        break;
+    }
+}
+
+static void engine(void *par)
+{
+    ws2812_anim_t *anim = par;
+    unsigned int next = CNT;
+
+    while (!anim->stopping) {
+        if (mailbox_pending(&anim->box)) {
+            anim->effect = *(ws2812_effect_t *)mailbox_receive(&anim->box);
+            mailbox_finish(&anim->box);
+            anim->step = 0;
+            anim->random = anim->effect.seed;
+        }
+        render(anim, ws2812_begin_frame(&anim->frame));
+        ws2812_commit(&anim->frame);
+        anim->step++;
+
+        // frames that take too long to draw push the next ones back
+        next += anim->ticks;
+        if ((int)(next - CNT) > 0)
+            waitcnt(next);
+        else
+            next = CNT;
+    }
+    ws2812_flush(&anim->frame);
+    anim->stopping = 0;
+    cogstop(cogid());
+}
+
+int ws2812_anim_start(ws2812_anim_t *anim, ws2812_t *driver, int pin,
+                      uint32_t *front, uint32_t *back, int count, int fps)
+{
+    anim->cog = -1;
+    if (fps <= 0 || count <= 0)
+        return -1;
+    ws2812_frame_init(&anim->frame, driver, pin, front, back, count);
+    mailbox_init(&anim->box, anim->slots, WS2812_ANIM_QUEUE);
+    anim->effect.effect = WS2812_FILL;
+    anim->effect.color = COLOR_BLACK;
+    anim->ticks = CLKFREQ / fps;
+    anim->step = 0;
+    anim->stopping = 0;
+    if (st_stackAdd)
+        st_stackAdd("ws2812_anim", anim->stack, sizeof(anim->stack));
+    anim->cog = cogstart(engine, anim, anim->stack, sizeof(anim->stack));
+    return anim->cog;
+}
+
+unsigned int ws2812_anim_post(ws2812_anim_t *anim, ws2812_effect_t *effect)
+{
+    ws2812_effect_t *copy;
+
+    // the copy goes in the slot the request will use, once it is free
+    while (mailbox_pending(&anim->box) == WS2812_ANIM_QUEUE)
+        ;
+    copy = &anim->posted[anim->box.head & anim->box.mask];
+    *copy = *effect;
+    return mailbox_post(&anim->box, (unsigned int)copy);
+}
+
+void ws2812_anim_stop(ws2812_anim_t *anim)
+{
+    if (anim->cog >= 0) {
+        anim->stopping = 1;
+        while (anim->stopping)
+            ;
+        if (st_stackRemove)
+            st_stackRemove(anim->stack);
+        anim->cog = -1;
+    }
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
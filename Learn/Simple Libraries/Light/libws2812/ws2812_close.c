@@ -16,7 +16,7 @@
 
 void ws2812_close(ws2812_t *state)
 {
-    while(state->command);
+    ws2812_wait(state, 0);
     ws2812_stop(state);
     free(state);
 }
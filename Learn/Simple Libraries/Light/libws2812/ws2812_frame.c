@@ -0,0 +1,96 @@
+/**
+ * @file ws2812_frame.c
+ *
+ * @author Parallax Inc.
+ *
+ * @version 0.85
+ *
+ * @copyright
+ * Copyright (c) Parallax Inc. 2014, All Rights MIT Licensed.
+ *
+ * @brief Double-buffered frames for a chain of WS2812 LEDs.
+ */
+
+#include "ws2812.h"
+
+void ws2812_frame_init(ws2812_frame_t *frame, ws2812_t *driver, int pin,
+                       uint32_t *front, uint32_t *back, int count)
+{
+    frame->driver     = driver;
+    frame->cmd.count  = count;
+    frame->cmd.pin    = pin;
+    frame->cmd.strips = 1;
+    frame->cmd.flags  = 0;
+    frame->front      = front;
+    frame->back       = back;
+    frame->id         = 0;
+    frame->held       = 0;
+    frame->frames     = 0;
+    frame->dropped    = 0;
+}
+
+// send the held frame if the driver is done with the front buffer
+static int send(ws2812_frame_t *frame)
+{
+    uint32_t *sent;
+
+    if (!frame->held)
+        return 0;
+    if (frame->id && !mailbox_done(&frame->driver->box, frame->id))
+        return 0;
+    frame->cmd.colors = frame->back;
+    frame->id = ws2812_send(frame->driver, &frame->cmd);
+    sent = frame->back;
+    frame->back = frame->front;
+    frame->front = sent;
+    frame->held = 0;
+    frame->frames++;
+    return 1;
+}
+
+uint32_t *ws2812_begin_frame(ws2812_frame_t *frame)
+{
+    // a frame still held when the next one starts is never sent
+    if (frame->held && !send(frame)) {
+        frame->held = 0;
+        frame->dropped++;
+    }
+    return frame->back;
+}
+
+int ws2812_commit(ws2812_frame_t *frame)
+{
+    frame->held = 1;
+    return send(frame);
+}
+
+void ws2812_flush(ws2812_frame_t *frame)
+{
+    if (frame->held && frame->id)
+        mailbox_wait(&frame->driver->box, frame->id);
+    send(frame);
+    if (frame->id)
+        mailbox_wait(&frame->driver->box, frame->id);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,80 @@
+/**
+ * @file ws2812_gamma.c
+ *
+ * @author Parallax Inc.
+ *
+ * @version 0.85
+ *
+ * @copyright
+ * Copyright (c) Parallax Inc. 2014, All Rights MIT Licensed.
+ *
+ * @brief Gamma and brightness table for the WS2812 driver.
+ */
+
+#include "ws2812.h"
+
+// levels are 8.8 fixed point, 0 to 255.0; gamma curves between whole
+// powers blend the powers on either side
+static void fill(uint16_t *levels, int gamma, int brightness)
+{
+    uint32_t i, lo, hi, level;
+    int part;
+
+    if (gamma < 10)
+        gamma = 10;
+    if (gamma > 30)
+        gamma = 30;
+    for (i = 0; i < 256; i++) {
+        lo = i << 8;                            // i
+        hi = i * i * 256 / 255;                 // i squared
+        part = gamma - 10;
+        if (gamma > 20) {
+            lo = hi;
+            hi = i * i * i * 256 / (255 * 255); // i cubed
+            part = gamma - 20;
+        }
+        level = lo - (lo - hi) * part / 10;
+        levels[i] = level * brightness / 255;
+    }
+}
+
+void ws2812_gamma(ws2812_t *state, uint16_t *levels, int gamma)
+{
+    state->gamma = gamma;
+    if (levels)
+        fill(levels, gamma, state->brightness);
+    state->levels = levels;
+}
+
+void ws2812_brightness(ws2812_t *state, int brightness)
+{
+    if (brightness < 0)
+        brightness = 0;
+    if (brightness > 255)
+        brightness = 255;
+    state->brightness = brightness;
+    if (state->levels)
+        fill(state->levels, state->gamma, brightness);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -21,6 +21,7 @@ void ms_timer(void *par);
 int mstime_start()
 {
   mstime_stop();
+  if(st_stackAdd) st_stackAdd("mstimer", stack, sizeof(stack));
   cog = 1 + cogstart(ms_timer, NULL, stack, sizeof(stack));
 }
 
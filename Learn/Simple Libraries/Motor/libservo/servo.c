@@ -222,6 +222,7 @@ static int servo_start(void)                         // Take cog & start servo p
   if(lockID == -1) return -1;                        // Return -1 if no locks
   else lockclr(lockID);
   servo_stop();                                      // Stop in case cog is running
+  if(st_stackAdd) st_stackAdd("servo", stack, sizeof(stack));
   servoCog = cogstart(servo, NULL, stack,            // Launch servo into new cog
              sizeof(stack)) + 1;
   return servoCog;
@@ -211,6 +211,7 @@ static int servoAux_start(void)                      // Take cog & start servo p
   if(lockID == -1) return -1;                        // Return -1 if no locks
   else lockclr(lockID);
   servoAux_stop();                                   // Stop in case cog is running
+  if(st_stackAdd) st_stackAdd("servoAux", stack, sizeof(stack));
   servoAuxCog = cogstart(servoAux, NULL, stack,      // Launch servo into new cog
              sizeof(stack)) + 1;
   return servoAuxCog;
@@ -409,6 +409,7 @@ void set_drive_speed(int left, int right)
   if(!cog)
   {
     /////print("\n\n!!!!! Starting COG !!!!!!\n\n");
+    if(st_stackAdd) st_stackAdd("abdrive", stack, sizeof(stack));
     cog = 1 + cogstart(encoders, NULL, stack, sizeof(stack)-1);
   }  
 }
@@ -671,6 +672,7 @@ void encoders(void *par)
     if((CNT - t) >= (dt1 + dt2))
     {
       t+=(dt1+dt2);
+      TRACE_BEGIN(TRACE_ID_ABDRIVE);
       //oneshot = 0;
       //pulseTime = CNT;
       _sprOld = _servoPulseReps;
@@ -787,6 +789,7 @@ void encoders(void *par)
         ridx += 11;
       }
       #endif // interactive_development_mode
+      TRACE_END(TRACE_ID_ABDRIVE);
     }
   }
 }
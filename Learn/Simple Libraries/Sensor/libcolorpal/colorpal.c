@@ -91,11 +91,11 @@ colorPal *colorPal_open(int sioPin)
   //memset(idstr, 0, 12);
 
   /* can't use array instead of malloc because it would go out of scope. */
-  char* bufptr = (char*) malloc(2*(FDSERIAL_BUFF_MASK+1));
-  colorPal* term = (colorPal*) malloc(sizeof(colorPal));
+  char* bufptr = (char*) mem_get(2*(FDSERIAL_BUFF_MASK+1));
+  colorPal* term = (colorPal*) mem_get(sizeof(colorPal));
   memset(term, 0, sizeof(colorPal));
 
-  colpalptr = (void*) malloc(sizeof(colorPal_t));
+  colpalptr = (void*) mem_get(sizeof(colorPal_t));
   term->devst = colpalptr;
   memset((char*)colpalptr, 0, sizeof(colorPal_t));
 
@@ -127,7 +127,8 @@ colorPal *colorPal_open(int sioPin)
   }
 #else
 */
-  term->cogid[0] = setStopCOGID(cognew((void*)binary_pst_dat_start, (void*)colpalptr));
+  term->cogid[0] = setStopCOGID(cog_imageStart(binary_pst_dat_start,
+                    cog_imageLoad(binary_pst_dat_start), (void*)colpalptr));
 //#endif
 
   waitcnt(CLKFREQ/10+CNT); // give cog chance to load
@@ -149,10 +150,10 @@ void colorPal_close(colorPal *device)
 
   if(id > 0) cogstop(getStopCOGID(id));
   
-  free((void*)colpalptr->buffptr);
+  mem_put((void*)colpalptr->buffptr);
   //free((void*)colpalptr->idstr);
-  free((void*)colpalptr);
-  free(device);
+  mem_put((void*)colpalptr);
+  mem_put(device);
   device = 0;
 }
 
@@ -40,6 +40,7 @@ void gps_run(void *par)
 
       fdserial_close(gps_ser);
       gps_stopping = 0;
+      cogstop(cogid());     // don't read the closed port before gps_close's cogstop
     }
     ch = fdserial_rxChar(gps_ser);
     
@@ -59,12 +60,14 @@ void gps_run(void *par)
 
     //got the full sentence, do a little prep work to get ready for parsing.
     //modifies inBuff!
+    TRACE_BEGIN(TRACE_ID_GPS);
     PrepBuff();
 
     if(strncmp(inBuff, "GPRMC", 5) == 0)
       ParseRMC();
     if(strncmp(inBuff, "GPGGA", 5) == 0)
       ParseGGA();
+    TRACE_END(TRACE_ID_GPS);
   }
 }
 
@@ -28,15 +28,15 @@ rfidser *rfid_open(int soutPin, int enablePin)
 
   rfid_st *rfidptr;
 
-  char* idstr = (char*) malloc(12);
+  char* idstr = (char*) mem_get(12);
   memset(idstr, 0, 12);
 
   /* can't use array instead of malloc because it would go out of scope. */
-  char* bufptr = (char*) malloc(2*(FDSERIAL_BUFF_MASK+1));
-  rfidser* term = (rfidser*) malloc(sizeof(rfidser));
+  char* bufptr = (char*) mem_get(2*(FDSERIAL_BUFF_MASK+1));
+  rfidser* term = (rfidser*) mem_get(sizeof(rfidser));
   memset(term, 0, sizeof(rfidser));
 
-  rfidptr = (void*) malloc(sizeof(rfid_st));
+  rfidptr = (void*) mem_get(sizeof(rfid_st));
   term->devst = rfidptr;
   memset((char*)rfidptr, 0, sizeof(rfid_st));
 
@@ -60,14 +60,19 @@ rfidser *rfid_open(int soutPin, int enablePin)
 
 
   /* now start the kernel */
+  { void *code = cog_imageLoad(binary_pst_dat_start);
 #if defined(__PROPELLER_USE_XMM__)
-  { unsigned int buffer[2048];
-    memcpy(buffer, binary_pst_dat_start, 2048);
-    term->cogid[0] = cognew(buffer, (void*)rfidptr) + 1;
-  }
+    unsigned int buffer[2048];
+    if(code == binary_pst_dat_start)
+    {
+      memcpy(buffer, binary_pst_dat_start, 2048);
+      code = buffer;
+    }
+    term->cogid[0] = cog_imageStart(buffer, code, (void*)rfidptr) + 1;
 #else
-  term->cogid[0] = setStopCOGID(cognew((void*)binary_pst_dat_start, (void*)rfidptr));
+    term->cogid[0] = setStopCOGID(cog_imageStart(binary_pst_dat_start, code, (void*)rfidptr));
 #endif
+  }
   waitcnt(CLKFREQ/2+CNT); // give cog chance to load
   rfid_reset(term);
 
@@ -86,10 +91,10 @@ void rfidser_close(rfidser *device)
 
   if(id > 0) cogstop(getStopCOGID(id));
   
-  free((void*)rfidp->buffptr);
-  free((void*)rfidp->idstr);
-  free((void*)rfidp);
-  free(device);
+  mem_put((void*)rfidp->buffptr);
+  mem_put((void*)rfidp->idstr);
+  mem_put((void*)rfidp);
+  mem_put(device);
   device = 0;
 }
 
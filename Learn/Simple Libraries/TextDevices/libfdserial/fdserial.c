@@ -7,6 +7,7 @@
  * See end of file for terms of use.
  */
 #include <stdlib.h>
+#include "simpletools.h"
 #include "fdserial.h"
 
 /*
@@ -24,11 +25,11 @@ fdserial *fdserial_open(int rxpin, int txpin, int mode, int baudrate)
   fdserial_st *fdptr;
 
   /* can't use array instead of malloc because it would go out of scope. */
-  char* bufptr = (char*) malloc(2*(FDSERIAL_BUFF_MASK+1));
-  fdserial* term = (fdserial*) malloc(sizeof(fdserial));
+  char* bufptr = (char*) mem_get(2*(FDSERIAL_BUFF_MASK+1));
+  fdserial* term = (fdserial*) mem_get(sizeof(fdserial));
   memset(term, 0, sizeof(fdserial));
 
-  fdptr = (void*) malloc(sizeof(fdserial_st));
+  fdptr = (void*) mem_get(sizeof(fdserial_st));
   term->devst = fdptr;
   memset((char*)fdptr, 0, sizeof(fdserial_st));
 
@@ -50,14 +51,19 @@ fdserial *fdserial_open(int rxpin, int txpin, int mode, int baudrate)
   fdptr->buffptr = bufptr; /* receive and transmit buffer */
 
   /* now start the kernel */
+  { void *code = cog_imageLoad(binary_pst_dat_start);
 #if defined(__PROPELLER_USE_XMM__)
-  { unsigned int buffer[2048];
-    memcpy(buffer, binary_pst_dat_start, 2048);
-    term->cogid[0] = cognew(buffer, (void*)fdptr) + 1;
-  }
+    unsigned int buffer[2048];
+    if(code == binary_pst_dat_start)
+    {
+      memcpy(buffer, binary_pst_dat_start, 2048);
+      code = buffer;
+    }
+    term->cogid[0] = cog_imageStart(buffer, code, (void*)fdptr) + 1;
 #else
-  term->cogid[0] = setStopCOGID(cognew((void*)binary_pst_dat_start, (void*)fdptr));
+    term->cogid[0] = setStopCOGID(cog_imageStart(binary_pst_dat_start, code, (void*)fdptr));
 #endif
+  }
   waitcnt(CLKFREQ/2+CNT); // give cog chance to load
   return term;
 }
@@ -76,9 +82,9 @@ void fdserial_close(fdserial *term)
 
   if(id > 0) cogstop(getStopCOGID(id));
   
-  free((void*)fdp->buffptr);
-  free((void*)fdp);
-  free(term);
+  mem_put((void*)fdp->buffptr);
+  mem_put((void*)fdp);
+  mem_put(term);
   term = 0;
 }
 
@@ -21,6 +21,7 @@ __attribute__((fcache)) static int _inbyte(int bitcycles, int cycle1, int rxmask
 
   /* index initialized above */
   while(j-- > 0) {
+#if defined(__propeller__)
     /* C code is too big for fcache in xmm memory models.
     // waitcycles = waitcnt2(waitcycles, bitcycles); */
     __asm__ volatile("waitcnt %[_waitcycles], %[_bitcycles]"
@@ -33,6 +34,11 @@ __attribute__((fcache)) static int _inbyte(int bitcycles, int cycle1, int rxmask
                      "muxnz %[_value], #1<<7"
                      : [_value] "+r" (value)
                      : [_mask] "r" (rxmask));
+#else
+    /* Host builds (libhostsim) */
+    waitcycles = waitcnt2(waitcycles, bitcycles);
+    value = ( (0 != (INA & rxmask)) << 7) | (value >> 1);
+#endif
   }
   return value; /* fcached 0x40 or 64 bytes */
 }
@@ -63,6 +69,7 @@ __attribute__((fcache)) static void _outbyte(int bitcycles, int txmask, int valu
 
   waitcycles = CNT + bitcycles;
   while(j-- > 0) {
+#if defined(__propeller__)
     /* C code is too big and not fast enough for all memory models.
     // waitcycles = waitcnt2(waitcycles, bitcycles); */
     __asm__ volatile("waitcnt %[_waitcycles], %[_bitcycles]"
@@ -74,6 +81,12 @@ __attribute__((fcache)) static void _outbyte(int bitcycles, int txmask, int valu
                      "muxc outa, %[_mask]"
                      : [_value] "+r" (value)
                      : [_mask] "r" (txmask));
+#else
+    /* Host builds (libhostsim) */
+    waitcycles = waitcnt2(waitcycles, bitcycles);
+    if (value & 1) OUTA |= txmask; else OUTA &= ~txmask;
+    value = value >> 1;
+#endif
   }
 }
 
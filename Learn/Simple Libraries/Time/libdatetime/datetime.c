@@ -42,6 +42,8 @@ void dt_set(datetime dt)
 void dt_run(datetime dt)
 {
   int et = dt_toEt(dt);
+  dt_end();                                   // Not while a cog uses it
+  if(st_stackAdd) st_stackAdd("datetime", stack, sizeof(stack));
   dt_cog = 1 + cogstart(secondctr, (int*) et, stack, sizeof(stack));
 }
 
@@ -49,7 +51,7 @@ void dt_end()
 {
   if(dt_cog)
   {
-    cogstop(dt_cog);
+    cogstop(dt_cog - 1);
     dt_cog = 0;
   }
 }
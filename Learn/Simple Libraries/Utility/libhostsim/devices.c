@@ -0,0 +1,383 @@
+/*
+ * @file devices.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Simulated devices for libhostsim: serial senders and receivers,
+ * the P30/P31 terminal, and an I2C EEPROM.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "hostsim.h"
+
+#define UARTS 8
+
+void sim_external(int change);
+void sim_lock(int on);
+int sim_rx_waiting(int pin);
+
+
+
+/* Serial sender: drives a pin from outside */
+
+typedef struct
+{
+  int pin, ticks, bit;
+  unsigned char *buf;
+  int len, pos, size;
+} uart_tx_t;
+
+static uart_tx_t uartTx[UARTS];
+
+static void uart_tx_bit(void *arg)
+{
+  uart_tx_t *u = arg;
+  int byte = u->buf[u->pos];
+  if(u->bit == 0) sim_input(u->pin, 0);                   // Start bit
+  else if(u->bit < 9) sim_input(u->pin, (byte >> (u->bit - 1)) & 1);
+  else sim_input(u->pin, 1);                              // Stop bit
+  if(++u->bit == 10)
+  {
+    u->bit = 0;
+    if(++u->pos == u->len)
+    {
+      u->pos = u->len = 0;
+      return;
+    }
+  }
+  sim_at(sim_now() + u->ticks, uart_tx_bit, u);
+}
+
+void sim_uart_send(int pin, int baud, const char *data, int length)
+{
+  uart_tx_t *u = 0;
+  sim_lock(1);
+  for(int i = 0; i < UARTS && !u; i++)
+    if(uartTx[i].size && uartTx[i].pin == pin) u = &uartTx[i];
+  for(int i = 0; i < UARTS && !u; i++)
+    if(!uartTx[i].size) u = &uartTx[i];
+  if(!u || length <= 0)
+  {
+    sim_lock(0);
+    return;
+  }
+  u->pin = pin;
+  u->ticks = CLKFREQ / baud;
+  if(u->len + length > u->size)
+  {
+    u->size = (u->len + length) * 2;
+    u->buf = realloc(u->buf, u->size);
+  }
+  memcpy(u->buf + u->len, data, length);
+  int idle = u->len == 0;
+  u->len += length;
+  if(idle)
+  {
+    sim_input(pin, 1);
+    sim_at(sim_now() + u->ticks, uart_tx_bit, u);
+  }
+  sim_lock(0);
+}
+
+
+
+/* Serial receiver: decodes what the Propeller sends on a pin */
+
+typedef struct
+{
+  int pin, ticks, bit, byte;
+  void (*fn)(int pin, int byte);
+} uart_rx_t;
+
+static uart_rx_t uartRx[UARTS];
+static int uartRxs;
+
+static void uart_rx_bit(void *arg)
+{
+  uart_rx_t *u = arg;
+  u->byte |= ((sim_pins() >> u->pin) & 1) << u->bit;
+  if(++u->bit < 8)
+    sim_at(sim_now() + u->ticks, uart_rx_bit, u);
+  else
+  {
+    u->bit = -1;
+    u->fn(u->pin, u->byte);
+  }
+}
+
+static void uart_rx_watch(sim_time_t t, unsigned int pins, unsigned int changed)
+{
+  for(int i = 0; i < uartRxs; i++)
+  {
+    uart_rx_t *u = &uartRx[i];
+    int mask = 1 << u->pin;
+    if(u->bit < 0 && (changed & mask) && !(pins & mask))    // Start bit
+    {
+      u->bit = 0;
+      u->byte = 0;
+      sim_at(t + u->ticks + u->ticks / 2, uart_rx_bit, u);
+    }
+  }
+}
+
+int sim_uart_watch(int pin, int baud, void (*fn)(int pin, int byte))
+{
+  if(uartRxs == UARTS) return -1;
+  uart_rx_t *u = &uartRx[uartRxs];
+  u->pin = pin;
+  u->ticks = CLKFREQ / baud;
+  u->bit = -1;
+  u->fn = fn;
+  if(!uartRxs++) sim_watch(uart_rx_watch);
+  return 0;
+}
+
+
+
+/* Terminal on P30 (to stdout) and P31 (from stdin) */
+
+static void term_out(int pin, int byte)
+{
+  static int cr;
+  (void) pin;
+  if(byte == '\r') putchar('\n');
+  else if(byte == '\n' && cr);
+  else if(byte >= ' ' || byte == '\n' || byte == '\t') putchar(byte);
+  cr = byte == '\r';
+  if(byte == '\r' || byte == '\n') fflush(stdout);
+}
+
+static struct
+{
+  char buf[256];
+  int len, eof;
+} term;
+
+void sim_term_feed(void)                      // A receiver is listening on P31
+{
+  sim_lock(1);
+  int busy = 0;
+  for(int i = 0; i < UARTS; i++)
+    if(uartTx[i].pin == 31 && uartTx[i].len) busy = 1;
+  if(term.len && !busy)
+  {
+    sim_uart_send(31, 115200, term.buf, 1);
+    memmove(term.buf, term.buf + 1, --term.len);
+    if(!term.len && term.eof) sim_external(-1);
+  }
+  sim_lock(0);
+}
+
+static void *term_in(void *arg)               // Typed bytes wait until a
+{                                             // receiver listens for them
+  char c;
+  (void) arg;
+  for(;;)
+  {
+    sim_lock(1);
+    int full = term.len == sizeof(term.buf);
+    sim_lock(0);
+    if(full)
+    {
+      usleep(1000);
+      continue;
+    }
+    if(read(0, &c, 1) != 1) break;
+    sim_lock(1);
+    term.buf[term.len++] = c == '\n' ? '\r' : c;
+    sim_lock(0);
+    if(sim_rx_waiting(31)) sim_term_feed();
+  }
+  sim_lock(1);
+  term.eof = 1;
+  if(!term.len) sim_external(-1);
+  sim_lock(0);
+  return NULL;
+}
+
+
+
+/* 24LC512-style I2C EEPROM */
+
+enum {EE_IDLE, EE_DEVICE, EE_ADDRHI, EE_ADDRLO, EE_WRITE, EE_READ};
+
+static struct
+{
+  int scl, sda;
+  int state, bits, byte, ack, nak;
+  unsigned int addr;
+  unsigned char mem[65536];
+  const char *file;
+} ee = {-1, -1};
+
+static void ee_sda(int state)
+{
+  if(state) sim_float(ee.sda);                // Open drain, pulled up
+  else sim_input(ee.sda, 0);
+}
+
+static void ee_watch(sim_time_t t, unsigned int pins, unsigned int changed)
+{
+  unsigned int scl = 1 << ee.scl, sda = 1 << ee.sda;
+  (void) t;
+  if(!(changed & (scl | sda))) return;
+  if(!(changed & scl))
+  {
+    if(!(pins & scl)) return;
+    ee_sda(1);
+    if(!(pins & sda))                         // Start (or repeated start)
+    {
+      ee.state = EE_DEVICE;
+      ee.bits = ee.byte = ee.ack = 0;
+    }
+    else ee.state = EE_IDLE;                  // Stop
+    return;
+  }
+  if(ee.state == EE_IDLE) return;
+  if(pins & scl)                              // Clock high: master's bits
+  {
+    if(ee.ack && ee.state == EE_READ) ee.nak = (pins & sda) != 0;
+    else if(!ee.ack && ee.state != EE_READ)
+    {
+      ee.byte = (ee.byte << 1) | ((pins & sda) != 0);
+      ee.bits++;
+    }
+    return;
+  }
+  if(ee.ack)                                  // Clock low after ack bit
+  {
+    ee.ack = 0;
+    ee_sda(1);
+    if(ee.state == EE_READ)
+    {
+      if(ee.nak)
+      {
+        ee.state = EE_IDLE;
+        return;
+      }
+      ee.bits = 0;
+      ee.byte = ee.mem[ee.addr];
+      ee.addr = (ee.addr + 1) & 0xFFFF;
+    }
+    else
+    {
+      ee.bits = ee.byte = 0;
+      return;
+    }
+  }
+  if(ee.state == EE_READ)                     // Clock low: our bits out
+  {
+    if(ee.bits < 8) ee_sda((ee.byte >> (7 - ee.bits++)) & 1);
+    else
+    {
+      ee_sda(1);
+      ee.ack = 1;
+      ee.nak = 0;
+    }
+    return;
+  }
+  if(ee.bits < 8) return;
+  switch(ee.state)
+  {
+    case EE_DEVICE:
+      if((ee.byte & 0xFE) != 0xA0)
+      {
+        ee.state = EE_IDLE;
+        return;
+      }
+      ee.state = (ee.byte & 1) ? EE_READ : EE_ADDRHI;
+      if(ee.state == EE_READ) ee.nak = 0;
+      break;
+    case EE_ADDRHI:
+      ee.addr = ee.byte << 8;
+      ee.state = EE_ADDRLO;
+      break;
+    case EE_ADDRLO:
+      ee.addr |= ee.byte;
+      ee.state = EE_WRITE;
+      break;
+    case EE_WRITE:                            // 128 byte pages wrap around
+      ee.mem[ee.addr] = ee.byte;
+      ee.addr = (ee.addr & 0xFF80) | ((ee.addr + 1) & 0x7F);
+      break;
+  }
+  ee_sda(0);                                  // Acknowledge
+  ee.ack = 1;
+}
+
+unsigned char *sim_eeprom(int sclPin, int sdaPin)
+{
+  static int watching;
+  ee.scl = sclPin;
+  ee.sda = sdaPin;
+  ee.state = EE_IDLE;
+  sim_pullup(sclPin, 1);
+  sim_pullup(sdaPin, 1);
+  if(!watching++) sim_watch(ee_watch);
+  return ee.mem;
+}
+
+static void ee_save(void)
+{
+  FILE *f = fopen(ee.file, "wb");
+  if(!f) return;
+  fwrite(ee.mem, 1, sizeof(ee.mem), f);
+  fclose(f);
+}
+
+
+
+void sim_devices_init(void)
+{
+  memset(ee.mem, 0xFF, sizeof(ee.mem));
+  sim_eeprom(28, 29);
+  ee.file = getenv("HOSTSIM_EEPROM");
+  if(ee.file)
+  {
+    FILE *f = fopen(ee.file, "rb");
+    if(f)
+    {
+      fread(ee.mem, 1, sizeof(ee.mem), f);
+      fclose(f);
+    }
+    atexit(ee_save);
+  }
+
+  const char *term = getenv("HOSTSIM_TERM");
+  if(term && !atoi(term)) return;
+  sim_pullup(31, 1);
+  sim_uart_watch(30, 115200, term_out);
+  sim_external(1);
+  pthread_t thread;
+  pthread_create(&thread, NULL, term_in, NULL);
+  pthread_detach(thread);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,1013 @@
+/*
+ * @file hostsim.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Simulated cogs, system clock, counter modules, locks and pin bus
+ * behind libhostsim's propeller.h.
+ *
+ * @detail Every cog is a host thread, but only the one holding the baton
+ * (sim.running) runs.  Each cog keeps its own time, and gives up the baton
+ * when another cog or a timed event is due before it, so things happen in
+ * simulated-time order.  A watchdog thread hands the baton on if its
+ * holder spends a few milliseconds of its own CPU time without a register
+ * access, which lets a cog waiting on a hub variable keep spinning while
+ * the others run.  It counts CPU time, not real time, so a cog that a busy
+ * host only set aside keeps the baton and results still repeat.  A
+ * detached cog rejoins at the current time on its next register access.  While a cog
+ * is detached, or every cog waits on pins that only an outside thread
+ * (the terminal) can change, pace() holds simulated time to real time.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hostsim.h"
+
+#define COGS 8
+#define LOCKS 8
+#define EVENTS 256
+#define WATCHERS 16
+#define DRIVERS 16
+#define NEVER (~0ULL)
+#define COGSTART_TICKS 8208                   // Loading 496 longs + setup
+#define WATCHDOG_US 2000
+#define COST(c) ((c)->cost >= 0 ? (c)->cost : sim.cost)
+
+enum {COG_OFF, COG_RUN, COG_READY, COG_WAITCNT, COG_WAITPEQ, COG_WAITPNE,
+      COG_DETACHED};
+
+typedef struct
+{
+  int state;
+  unsigned int gen;                           // Changes when stopped
+  sim_time_t t;                               // Cog's time, or wake time
+  volatile unsigned int reg[12];              // OUTA ... VSCL
+  sim_time_t ctrLast[2];                      // PHS integrated up to
+  sim_time_t ctrEdge[2];                      // Next NCO output change
+  int ctrDirty;
+  unsigned int waitState, waitMask;
+  unsigned int listen;                        // Pins it polls for input
+  int cost;                                   // Register access, or -1
+  unsigned long entries;                      // Register accesses
+  clockid_t clock;                            // Its thread's CPU time
+  void (*func)(void *par);
+  void *par;
+  pthread_cond_t cond;
+} cog_t;
+
+typedef struct
+{
+  sim_time_t t;
+  unsigned long seq;
+  void (*fn)(void *arg);
+  void *arg;
+} event_t;
+
+static struct
+{
+  pthread_mutex_t lock;
+  int init;
+  int running;                                // Cog with the baton, or -1
+  int scheduling;                             // In schedule()
+  sim_time_t now;
+  int cost;
+  unsigned int pins, ext, extMask, pullups;
+  int dirty;
+  cog_t cog[COGS];
+  int lockUsed[LOCKS], lockSet[LOCKS];
+  event_t event[EVENTS];
+  int events;
+  unsigned long seq;
+  sim_watch_t watcher[WATCHERS];
+  int watchers;
+  const void *image[DRIVERS];
+  void (*driver[DRIVERS])(void *par);
+  int drivers;
+  int external;                               // Threads that may inject
+  int realtime;
+  struct timespec start;
+  int pacing;                                 // Waiting on the real clock
+  pthread_cond_t wake;
+} sim;
+
+static __thread int simCog = -1;
+static __thread unsigned int simGen;
+
+unsigned int _clkfreq = 80000000;
+unsigned char _clkmode = 0x6F;
+
+void sim_devices_init(void);
+void sim_pst_init(void);
+void sim_waves_init(void);
+void sim_term_feed(void);
+void sim_pasm_cog(void *start);
+
+static void schedule(void);
+
+
+
+/* Counter modules */
+
+static int ctr_mode(cog_t *c, int k)
+{
+  return (c->reg[SIM_CTRA + k] >> 26) & 31;
+}
+
+static int pin_of(unsigned int pins, int n)
+{
+  return (pins >> (n & 31)) & 1;
+}
+
+static void ctr_integrate(cog_t *c, int k, sim_time_t t)
+{
+  if(t <= c->ctrLast[k]) return;
+  unsigned int ctr = c->reg[SIM_CTRA + k];
+  unsigned int frq = c->reg[SIM_FRQA + k];
+  int mode = (ctr >> 26) & 31;
+  int a = pin_of(sim.pins, ctr), b = pin_of(sim.pins, ctr >> 9);
+  int on;
+  if(mode == 0) on = 0;
+  else if(mode < 8) on = 1;                   // PLL, NCO, DUTY
+  else if(mode < 10) on = a;                  // POS detector
+  else if(mode < 12) on = 0;                  // POSEDGE (counted in bus_update)
+  else if(mode < 14) on = !a;                 // NEG detector
+  else if(mode < 16) on = 0;                  // NEGEDGE
+  else on = ((mode - 16) >> (a | (b << 1))) & 1;    // Logic modes
+  if(on) c->reg[SIM_PHSA + k] += frq * (unsigned int) (t - c->ctrLast[k]);
+  c->ctrLast[k] = t;
+}
+
+static unsigned int ctr_out(cog_t *c, int k, sim_time_t t)
+{
+  unsigned int ctr = c->reg[SIM_CTRA + k];
+  int mode = (ctr >> 26) & 31;
+  if(mode != 4 && mode != 5) return 0;
+  unsigned int phs = c->reg[SIM_PHSA + k] +
+                     c->reg[SIM_FRQA + k] * (unsigned int) (t - c->ctrLast[k]);
+  unsigned int out = 0;
+  if(phs & 0x80000000) out |= 1 << (ctr & 31);
+  else if(mode == 5) out |= 1 << ((ctr >> 9) & 31);
+  return out;
+}
+
+static void ctr_edge(cog_t *c, int k)
+{
+  int mode = ctr_mode(c, k);
+  unsigned int frq = c->reg[SIM_FRQA + k];
+  c->ctrEdge[k] = NEVER;
+  if((mode != 4 && mode != 5) || !frq) return;
+  unsigned long long phs = c->reg[SIM_PHSA + k], dist, step;
+  if(frq < 0x80000000)                        // Counting up
+  {
+    step = frq;
+    dist = (phs & 0x80000000) ? 0x100000000ULL - phs : 0x80000000ULL - phs;
+  }
+  else                                        // Counting down
+  {
+    step = 0x100000000ULL - frq;
+    dist = (phs & 0x80000000) ? phs - 0x80000000ULL + 1 : phs + 1;
+  }
+  c->ctrEdge[k] = c->ctrLast[k] + (dist + step - 1) / step;
+}
+
+
+
+/* Pin bus */
+
+static unsigned int bus_compute(sim_time_t t)
+{
+  unsigned int driven = 0, out = 0;
+  for(int i = 0; i < COGS; i++)
+  {
+    cog_t *c = &sim.cog[i];
+    if(c->state == COG_OFF) continue;
+    unsigned int dir = c->reg[SIM_DIRA];
+    driven |= dir;
+    out |= dir & (c->reg[SIM_OUTA] | ctr_out(c, 0, t) | ctr_out(c, 1, t));
+  }
+  unsigned int floating = (sim.ext & sim.extMask) | (sim.pullups & ~sim.extMask);
+  return out | (~driven & floating);
+}
+
+static void bus_update(sim_time_t t)
+{
+  while(sim.dirty)
+  {
+    sim.dirty = 0;
+    unsigned int pins = bus_compute(t);
+    unsigned int changed = pins ^ sim.pins;
+    if(!changed) continue;
+    for(int i = 0; i < COGS; i++)
+    {
+      cog_t *c = &sim.cog[i];
+      if(c->state == COG_OFF) continue;
+      for(int k = 0; k < 2; k++)
+      {
+        int mode = ctr_mode(c, k);
+        if(mode < 8) continue;
+        ctr_integrate(c, k, t);               // Up to now with old pins
+        unsigned int apin = c->reg[SIM_CTRA + k] & 31;
+        if(!(changed & (1 << apin))) continue;
+        int a = pin_of(pins, apin);
+        if(((mode == 10 || mode == 11) && a) || ((mode == 14 || mode == 15) && !a))
+          c->reg[SIM_PHSA + k] += c->reg[SIM_FRQA + k];
+      }
+    }
+    sim.pins = pins;
+    for(int i = 0; i < sim.watchers; i++) sim.watcher[i](t, pins, changed);
+    for(int i = 0; i < COGS; i++)
+    {
+      cog_t *c = &sim.cog[i];
+      int match = (pins & c->waitMask) == c->waitState;
+      if((c->state == COG_WAITPEQ && match) || (c->state == COG_WAITPNE && !match))
+      {
+        c->state = COG_READY;
+        c->t = t;
+      }
+    }
+  }
+}
+
+static sim_time_t time_now(void)
+{
+  if(simCog >= 0 && sim.running == simCog) return sim.cog[simCog].t;
+  return sim.now;
+}
+
+
+
+/* Scheduling */
+
+static sim_time_t next_event(int exclude, int *cog, int *event, int *ctr)
+{
+  sim_time_t next = NEVER;
+  *cog = *event = *ctr = -1;
+  for(int i = 0; i < sim.events; i++)
+  {
+    event_t *e = &sim.event[i];
+    if(e->t < next || (e->t == next && e->seq < sim.event[*event].seq))
+    {
+      next = e->t;
+      *event = i;
+    }
+  }
+  for(int i = 0; i < COGS; i++)
+  {
+    cog_t *c = &sim.cog[i];
+    if(c->state == COG_OFF) continue;
+    for(int k = 0; k < 2; k++)
+    {
+      if(c->ctrEdge[k] < next)
+      {
+        next = c->ctrEdge[k];
+        *event = -1;
+        *ctr = i * 2 + k;
+      }
+    }
+  }
+  for(int i = 0; i < COGS; i++)
+  {
+    cog_t *c = &sim.cog[i];
+    if(i == exclude) continue;
+    if((c->state == COG_READY || c->state == COG_WAITCNT) && c->t < next)
+    {
+      next = c->t;
+      *event = *ctr = -1;
+      *cog = i;
+    }
+  }
+  return next;
+}
+
+static void wake(void)                        // Cut pace short
+{
+  if(!sim.pacing) return;
+  sim.pacing = 0;
+  pthread_cond_broadcast(&sim.wake);
+}
+
+static int pace(sim_time_t t)                 // Hold simulated time to real
+{
+  struct timespec ts;
+  sim_time_t base;
+  if(sim.realtime)
+  {
+    ts = sim.start;
+    base = 0;
+  }
+  else
+  {
+    int detached = 0, busy = 0;               // A detached cog runs at host
+    for(int i = 0; i < COGS; i++)             // speed, and outside threads
+    {                                         // type in real time
+      int state = sim.cog[i].state;
+      if(state == COG_DETACHED) detached++;
+      if(state == COG_READY || state == COG_WAITCNT) busy++;
+    }
+    if(!detached && !(sim.external && !busy)) return 1;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    base = sim.now;
+  }
+  if(t <= base) return 1;
+  sim_time_t ticks = t - base;
+  int whole = 1;
+  if(!sim.realtime && ticks > (sim_time_t) _clkfreq / 10)
+  {
+    ticks = _clkfreq / 10;                    // Look again every 100 ms
+    whole = 0;
+  }
+  unsigned long long ns = ticks * 1000000000ULL / _clkfreq;
+  ts.tv_sec += ns / 1000000000ULL;
+  ts.tv_nsec += ns % 1000000000ULL;
+  if(ts.tv_nsec >= 1000000000L)
+  {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000L;
+  }
+  sim.pacing = 1;
+  while(sim.pacing && pthread_cond_timedwait(&sim.wake, &sim.lock, &ts) == 0);
+  if(!sim.pacing) return 0;                   // Woken by a new event
+  sim.pacing = 0;
+  if(!whole) sim.now = base + ticks;
+  return whole;
+}
+
+static void run_event(int event, int ctr, sim_time_t t)
+{
+  sim.now = t;
+  if(event >= 0)
+  {
+    event_t e = sim.event[event];
+    sim.event[event] = sim.event[--sim.events];
+    e.fn(e.arg);
+  }
+  else
+  {
+    cog_t *c = &sim.cog[ctr / 2];
+    ctr_integrate(c, ctr & 1, t);
+    ctr_edge(c, ctr & 1);
+    sim.dirty = 1;
+  }
+  bus_update(t);
+}
+
+static void schedule(void)
+{
+  sim.running = -1;
+  sim.scheduling = 1;
+  for(;;)
+  {
+    int cog, event, ctr;
+    sim_time_t t = next_event(-1, &cog, &event, &ctr);
+    if(t == NEVER)
+    {
+      int on = 0, detached = 0;
+      for(int i = 0; i < COGS; i++)
+      {
+        if(sim.cog[i].state != COG_OFF) on++;
+        if(sim.cog[i].state == COG_DETACHED) detached++;
+      }
+      sim.scheduling = 0;
+      if(detached || sim.external) return;
+      fflush(stdout);
+      if(!on) exit(0);
+      fprintf(stderr, "\nhostsim: all cogs are waiting for pins that never "
+                      "change\n");
+      exit(1);
+    }
+    if(!pace(t) || next_event(-1, &cog, &event, &ctr) != t) continue;
+    if(cog < 0)
+    {
+      run_event(event, ctr, t);
+      continue;
+    }
+    cog_t *c = &sim.cog[cog];
+    sim.now = t;
+    c->state = COG_RUN;
+    sim.running = cog;
+    sim.scheduling = 0;
+    pthread_cond_broadcast(&c->cond);
+    return;
+  }
+}
+
+static void wait_baton(cog_t *c)
+{
+  while(c->gen == simGen && !(sim.running == simCog && c->state == COG_RUN))
+    pthread_cond_wait(&c->cond, &sim.lock);
+  if(c->gen != simGen)
+  {
+    pthread_mutex_unlock(&sim.lock);
+    pthread_exit(NULL);
+  }
+}
+
+static void yield(cog_t *c, int state)
+{
+  c->state = state;
+  schedule();
+  wait_baton(c);
+}
+
+static void init(void);
+
+static void sync(cog_t *c)                    // Apply register writes
+{
+  if(c->ctrDirty)
+  {
+    c->ctrDirty = 0;
+    for(int k = 0; k < 2; k++)
+    {
+      ctr_integrate(c, k, c->t);
+      ctr_edge(c, k);
+    }
+  }
+  bus_update(c->t);
+}
+
+static cog_t *enter(void)
+{
+  if(!sim.init) init();
+  pthread_mutex_lock(&sim.lock);
+  if(simCog < 0)
+  {
+    fprintf(stderr, "hostsim: register access from a thread that is not a "
+                    "cog\n");
+    abort();
+  }
+  cog_t *c = &sim.cog[simCog];
+  if(c->gen != simGen) wait_baton(c);         // Stopped by another cog
+  if(c->state == COG_DETACHED)
+  {
+    c->state = COG_READY;
+    if(c->t < sim.now) c->t = sim.now;
+    sim.dirty = 1;                            // Its last store may have come
+                                              // after another cog's update
+    if(sim.running < 0 && !sim.scheduling) schedule();
+    else wake();
+    wait_baton(c);
+  }
+  c->entries++;
+  sim.now = c->t;
+  sync(c);
+  return c;
+}
+
+static void advance(cog_t *c, int ticks)
+{
+  c->t += ticks;
+  int cog, event, ctr;
+  if(next_event(simCog, &cog, &event, &ctr) < c->t) yield(c, COG_READY);
+  sim.now = c->t;
+}
+
+static void leave(void)
+{
+  pthread_mutex_unlock(&sim.lock);
+}
+
+
+
+/* Cog register and instruction stand-ins */
+
+volatile unsigned int *sim_reg(int reg)
+{
+  cog_t *c = enter();
+  advance(c, COST(c));
+  if(reg >= SIM_CTRA && reg <= SIM_PHSB)
+  {
+    int k = (reg - SIM_CTRA) & 1;
+    ctr_integrate(c, k, c->t);
+    c->ctrDirty = 1;
+  }
+  sim.dirty = 1;
+  volatile unsigned int *p = &c->reg[reg];
+  leave();
+  return p;
+}
+
+unsigned int sim_ina(void)
+{
+  cog_t *c = enter();
+  unsigned int pins = sim.pins;
+  advance(c, COST(c));
+  leave();
+  return pins;
+}
+
+unsigned int sim_cnt(void)
+{
+  cog_t *c = enter();
+  unsigned int cnt = (unsigned int) c->t;
+  advance(c, COST(c));
+  leave();
+  return cnt;
+}
+
+void sim_waitcnt(unsigned int target)
+{
+  cog_t *c = enter();
+  unsigned int delta = target - (unsigned int) c->t;
+  if(delta)
+  {
+    c->t += delta;
+    yield(c, COG_WAITCNT);
+  }
+  c->t += COST(c);
+  leave();
+}
+
+unsigned int sim_waitcnt2(unsigned int target, unsigned int delta)
+{
+  sim_waitcnt(target);
+  return target + delta;
+}
+
+static void waitp(unsigned int state, unsigned int mask, int eq)
+{
+  cog_t *c = enter();
+  if(((sim.pins & mask) == state) != eq)
+  {
+    c->waitState = state;
+    c->waitMask = mask;
+    c->state = eq ? COG_WAITPEQ : COG_WAITPNE;
+    if(mask & (1u << 31)) sim_term_feed();
+    yield(c, c->state);
+  }
+  c->t += COST(c);
+  leave();
+}
+
+void sim_waitpeq(unsigned int state, unsigned int mask)
+{
+  waitp(state, mask, 1);
+}
+
+void sim_waitpne(unsigned int state, unsigned int mask)
+{
+  waitp(state, mask, 0);
+}
+
+sim_time_t sim_spend(int ticks)               // For the PASM emulator
+{
+  cog_t *c = enter();
+  advance(c, ticks);
+  sim_time_t t = c->t;
+  leave();
+  return t;
+}
+
+void sim_cog_cost(int ticks)                  // -1 for sim_cost's value
+{
+  cog_t *c = enter();
+  c->cost = ticks;
+  leave();
+}
+
+int cogid(void)
+{
+  return simCog;
+}
+
+typedef struct
+{
+  int id;
+  unsigned int gen;
+} start_t;
+
+static void *cog_thread(void *arg)
+{
+  start_t s = *(start_t *) arg;
+  free(arg);
+  simCog = s.id;
+  simGen = s.gen;
+  pthread_mutex_lock(&sim.lock);
+  cog_t *c = &sim.cog[s.id];
+  if(c->gen == simGen) pthread_getcpuclockid(pthread_self(), &c->clock);
+  wait_baton(c);
+  void (*func)(void *) = c->func;
+  void *par = c->par;
+  leave();
+  func(par);
+  cogstop(s.id);
+  return NULL;
+}
+
+static int cog_launch(int id, void (*func)(void *), void *par)
+{
+  cog_t *c = enter();
+  if(id < 0)
+  {
+    for(id = 0; id < COGS && sim.cog[id].state != COG_OFF; id++);
+  }
+  else if(id != simCog && sim.cog[id].state != COG_OFF)
+  {
+    sim.cog[id].state = COG_OFF;
+    sim.cog[id].gen++;
+    pthread_cond_broadcast(&sim.cog[id].cond);
+  }
+  if(id >= COGS || id == simCog)
+  {
+    advance(c, COST(c));
+    leave();
+    return -1;
+  }
+  cog_t *n = &sim.cog[id];
+  n->gen++;
+  memset((void *) n->reg, 0, sizeof(n->reg));
+  n->listen = 0;
+  n->cost = -1;
+  n->t = c->t + COGSTART_TICKS;
+  n->ctrLast[0] = n->ctrLast[1] = n->t;
+  n->ctrEdge[0] = n->ctrEdge[1] = NEVER;
+  n->ctrDirty = 0;
+  n->func = func;
+  n->par = par;
+  n->state = COG_READY;
+  sim.dirty = 1;
+
+  start_t *s = malloc(sizeof(start_t));
+  s->id = id;
+  s->gen = n->gen;
+  pthread_t thread;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  pthread_create(&thread, &attr, cog_thread, s);
+  pthread_attr_destroy(&attr);
+
+  advance(c, COST(c));
+  leave();
+  return id;
+}
+
+int cogstart(void (*func)(void *), void *par, void *stack, size_t stacksize)
+{
+  (void) stack;
+  (void) stacksize;
+  return cog_launch(-1, func, par);
+}
+
+int coginit(int id, void *code, void *par)
+{
+  void (*fn)(void *) = 0;
+  pthread_mutex_lock(&sim.lock);
+  for(int i = 0; i < sim.drivers; i++)
+    if(sim.image[i] == code) fn = sim.driver[i];
+  pthread_mutex_unlock(&sim.lock);
+  if(!fn)                                     // Run the image itself
+  {
+    void **start = malloc(2 * sizeof(void *));
+    start[0] = code;
+    start[1] = par;
+    int cog = cog_launch(id & 8 ? -1 : id & 7, sim_pasm_cog, start);
+    if(cog < 0) free(start);
+    return cog;
+  }
+  return cog_launch(id & 8 ? -1 : id & 7, fn, par);
+}
+
+int _coginit(int par, int code, int id)       // spin2cpp's form
+{
+  return coginit(id, (void *) (uintptr_t) ((unsigned int) code << 2),
+                 (void *) (uintptr_t) ((unsigned int) par << 2));
+}
+
+void cogstop(int id)
+{
+  cog_t *c = enter();
+  cog_t *s = &sim.cog[id & 7];
+  if(s->state != COG_OFF)
+  {
+    s->state = COG_OFF;
+    s->gen++;
+    s->ctrEdge[0] = s->ctrEdge[1] = NEVER;
+    sim.dirty = 1;
+    bus_update(c->t);
+    pthread_cond_broadcast(&s->cond);
+  }
+  if(s == c)
+  {
+    schedule();
+    pthread_mutex_unlock(&sim.lock);
+    pthread_exit(NULL);
+  }
+  advance(c, COST(c));
+  leave();
+}
+
+int locknew(void)
+{
+  cog_t *c = enter();
+  int id;
+  for(id = 0; id < LOCKS && sim.lockUsed[id]; id++);
+  if(id < LOCKS)
+  {
+    sim.lockUsed[id] = 1;
+    sim.lockSet[id] = 0;
+  }
+  else id = -1;
+  advance(c, COST(c));
+  leave();
+  return id;
+}
+
+void lockret(int id)
+{
+  cog_t *c = enter();
+  sim.lockUsed[id & 7] = 0;
+  advance(c, COST(c));
+  leave();
+}
+
+int lockset(int id)
+{
+  cog_t *c = enter();
+  int was = sim.lockSet[id & 7];
+  sim.lockSet[id & 7] = 1;
+  advance(c, COST(c));
+  leave();
+  return was ? -1 : 0;
+}
+
+int lockclr(int id)
+{
+  cog_t *c = enter();
+  int was = sim.lockSet[id & 7];
+  sim.lockSet[id & 7] = 0;
+  advance(c, COST(c));
+  leave();
+  return was ? -1 : 0;
+}
+
+void clkset(int mode, int frequency)
+{
+  _clkmode = mode;
+  _clkfreq = frequency;
+}
+
+
+
+/* Test and device interface */
+
+sim_time_t sim_now(void)
+{
+  pthread_mutex_lock(&sim.lock);
+  sim_time_t t = time_now();
+  pthread_mutex_unlock(&sim.lock);
+  return t;
+}
+
+unsigned int sim_pins(void)
+{
+  return sim.pins;
+}
+
+void sim_cost(int ticks)
+{
+  sim.cost = ticks;
+}
+
+static void ext_set(int pin, int mask, int state)
+{
+  pthread_mutex_lock(&sim.lock);
+  unsigned int bit = 1 << (pin & 31);
+  if(mask) sim.extMask |= bit; else sim.extMask &= ~bit;
+  if(state) sim.ext |= bit; else sim.ext &= ~bit;
+  sim.dirty = 1;
+  bus_update(time_now());
+  pthread_mutex_unlock(&sim.lock);
+}
+
+void sim_input(int pin, int state)
+{
+  ext_set(pin, 1, state);
+}
+
+void sim_float(int pin)
+{
+  ext_set(pin, 0, 0);
+}
+
+void sim_pullup(int pin, int on)
+{
+  pthread_mutex_lock(&sim.lock);
+  if(on) sim.pullups |= 1 << (pin & 31);
+  else sim.pullups &= ~(1 << (pin & 31));
+  sim.dirty = 1;
+  bus_update(time_now());
+  pthread_mutex_unlock(&sim.lock);
+}
+
+int sim_watch(sim_watch_t fn)
+{
+  pthread_mutex_lock(&sim.lock);
+  int ok = sim.watchers < WATCHERS;
+  if(ok) sim.watcher[sim.watchers++] = fn;
+  pthread_mutex_unlock(&sim.lock);
+  return ok ? 0 : -1;
+}
+
+void sim_at(sim_time_t t, void (*fn)(void *arg), void *arg)
+{
+  pthread_mutex_lock(&sim.lock);
+  if(sim.events == EVENTS)
+  {
+    fprintf(stderr, "hostsim: too many timed events\n");
+    abort();
+  }
+  event_t *e = &sim.event[sim.events++];
+  e->t = t;
+  e->seq = sim.seq++;
+  e->fn = fn;
+  e->arg = arg;
+  if(sim.running < 0 && !sim.scheduling && simCog < 0) schedule();
+  else wake();
+  pthread_mutex_unlock(&sim.lock);
+}
+
+void sim_driver(const void *image, void (*fn)(void *par))
+{
+  pthread_mutex_lock(&sim.lock);
+  int i;
+  for(i = 0; i < sim.drivers && sim.image[i] != image; i++);
+  if(i < sim.drivers && !fn)                  // Back to the PASM emulator
+  {
+    sim.image[i] = sim.image[--sim.drivers];
+    sim.driver[i] = sim.driver[sim.drivers];
+  }
+  else if(fn && i < DRIVERS)
+  {
+    sim.image[i] = image;
+    sim.driver[i] = fn;
+    if(i == sim.drivers) sim.drivers++;
+  }
+  pthread_mutex_unlock(&sim.lock);
+}
+
+void sim_lock(int on)
+{
+  if(on) pthread_mutex_lock(&sim.lock);
+  else pthread_mutex_unlock(&sim.lock);
+}
+
+void sim_rx_listen(int pin, int on)           // This cog polls pin
+{
+  pthread_mutex_lock(&sim.lock);
+  if(on) sim.cog[simCog].listen |= 1u << pin;
+  else sim.cog[simCog].listen &= ~(1u << pin);
+  pthread_mutex_unlock(&sim.lock);
+}
+
+int sim_rx_waiting(int pin)                   // Anything listening on pin?
+{
+  unsigned int mask = 1u << pin;
+  pthread_mutex_lock(&sim.lock);
+  int waiting = 0;
+  for(int i = 0; i < COGS; i++)
+  {
+    cog_t *c = &sim.cog[i];
+    if(c->state == COG_OFF) continue;
+    if(c->listen & mask) waiting = 1;
+    if((c->state == COG_WAITPEQ || c->state == COG_WAITPNE)
+       && (c->waitMask & mask)) waiting = 1;
+  }
+  pthread_mutex_unlock(&sim.lock);
+  return waiting;
+}
+
+void sim_external(int change)
+{
+  pthread_mutex_lock(&sim.lock);
+  sim.external += change;
+  if(sim.running < 0 && !sim.scheduling) schedule();
+  else wake();
+  pthread_mutex_unlock(&sim.lock);
+}
+
+
+
+/* Startup */
+
+static long long cpu_us(cog_t *c)             // CPU time its thread has used
+{
+  struct timespec ts;
+  if(clock_gettime(c->clock, &ts)) return 0;  // Thread just ended
+  return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static void *watchdog(void *arg)
+{
+  int cog = -1;
+  unsigned long entries = 0;
+  long long used = 0;
+  (void) arg;
+  for(;;)
+  {
+    struct timespec ts = {0, WATCHDOG_US * 1000L};
+    nanosleep(&ts, NULL);
+    pthread_mutex_lock(&sim.lock);
+    int r = sim.running;
+    if(r >= 0 && r == cog && sim.cog[r].entries == entries)
+    {
+      int c, e, k;
+      if(cpu_us(&sim.cog[r]) - used < WATCHDOG_US)
+      {
+        pthread_mutex_unlock(&sim.lock);      // Not spinning yet, only
+        continue;                             // waiting for the host
+      }
+      if(next_event(r, &c, &e, &k) != NEVER)
+      {
+        sync(&sim.cog[r]);
+        sim.cog[r].state = COG_DETACHED;
+        schedule();
+      }
+      cog = -1;
+    }
+    else if(r >= 0)
+    {
+      cog = r;
+      entries = sim.cog[r].entries;
+      used = cpu_us(&sim.cog[r]);
+    }
+    pthread_mutex_unlock(&sim.lock);
+  }
+  return NULL;
+}
+
+static void timeout(void *arg)
+{
+  (void) arg;
+  fflush(stdout);
+  fprintf(stderr, "\nhostsim: stopped after HOSTSIM_TIMEOUT\n");
+  exit(1);
+}
+
+__attribute__((constructor(101))) static void init(void)
+{
+  if(sim.init) return;
+  sim.init = 1;
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&sim.lock, &attr);
+  pthread_condattr_t cattr;
+  pthread_condattr_init(&cattr);
+  pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+  pthread_cond_init(&sim.wake, &cattr);
+  for(int i = 0; i < COGS; i++)
+  {
+    pthread_cond_init(&sim.cog[i].cond, NULL);
+    sim.cog[i].ctrEdge[0] = sim.cog[i].ctrEdge[1] = NEVER;
+    sim.cog[i].cost = -1;
+  }
+  sim.cost = 16;
+  sim.cog[0].state = COG_RUN;                 // main runs in cog 0
+  sim.running = 0;
+  simCog = 0;
+  pthread_getcpuclockid(pthread_self(), &sim.cog[0].clock);
+  clock_gettime(CLOCK_MONOTONIC, &sim.start);
+
+  const char *env = getenv("HOSTSIM_REALTIME");
+  sim.realtime = env && atoi(env);
+  env = getenv("HOSTSIM_TIMEOUT");
+  if(env && atof(env) > 0)
+    sim_at((sim_time_t) (atof(env) * _clkfreq), timeout, NULL);
+
+  sim_devices_init();
+  sim_pst_init();
+  sim_waves_init();
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, watchdog, NULL);
+  pthread_detach(thread);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,320 @@
+/**
+ * @file hostsim.h
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Runs Simple Libraries C code on a Linux (or other POSIX) host
+ * computer for tests and benchmarks, without a Propeller board.
+ *
+ * @details libhostsim's include folder has stand-ins for propeller.h and
+ * the other PropGCC headers.  Compile library and application C files with
+ * it ahead of the usual include paths, link with libhostsim.a, and:
+ *
+ * @li Each cog started with cogstart or cog_run is a host thread.  Only one
+ * runs at a time, in the order the simulated system clock says it would,
+ * so results repeat from run to run.  A cog that spins on a hub variable
+ * without touching a cog register (for a few milliseconds of its own CPU
+ * time, so a busy host does not count) is let run in parallel until it
+ * does, and while it runs that way, simulated time is held to real time.
+ *
+ * @li CNT is a simulated system clock that starts at 0 and runs at
+ * CLKFREQ (80 MHz).  Code between register accesses takes no simulated
+ * time; each INA, OUTA, DIRA, CNT, CTR, FRQ or PHS access takes
+ * sim_cost clock ticks (default 16).  waitcnt, waitpeq and waitpne wait in
+ * simulated time, so pause(1000) returns as soon as the host gets there.
+ *
+ * @li OUTA and DIRA from every cog, plus counter module NCO outputs, drive
+ * a simulated 32-pin bus.  Test code and simulated devices drive inputs
+ * with sim_input, and watch outputs with sim_watch.  Counter modules
+ * support NCO, PLL (no output), DUTY (no output), POS/NEG detector,
+ * edge detector and logic modes.
+ *
+ * @li P30/P31 are connected to a 115200 baud terminal that prints to
+ * standard output and types standard input, so print and scan work.
+ * Typed bytes wait until the program listens for them, so piped input is
+ * not lost while the program is printing.
+ * P28/P29 have pull-up resistors and a 64 KB EEPROM, so ee_ functions and
+ * library calibration data work.
+ *
+ * @li cognew/coginit with a PASM image run a C stand-in registered with
+ * sim_driver, if there is one.  libhostsim provides one for the fdserial
+ * driver.  Other images run on a cycle-approximate cog emulator:
+ * instruction timing, hub slots, waits, counters and pins follow the
+ * P8X32A, and hub addresses are host addresses.  The Makefile assembles
+ * the libraries' .spin drivers with tools/spinasm.c.  A driver that packs
+ * a hub address into 16 bits only finds it within 32 KB of PAR, and only
+ * if its low 16 bits are $0008-$7FFF; higher ones read the ROM tables.
+ *
+ * @li sim_vcd_open records pin changes in a Value Change Dump file for a
+ * waveform viewer such as GTKWave, and sim_check_ws2812 and
+ * sim_check_servo hold a pin's pulses to those protocols' timing.
+ *
+ * Environment variables: HOSTSIM_TIMEOUT=s ends the program (exit status 1)
+ * after s simulated seconds, HOSTSIM_REALTIME=1 slows simulated time down to real
+ * time, HOSTSIM_EEPROM=file loads the EEPROM from a file and saves it back
+ * at exit, HOSTSIM_TERM=0 disconnects the terminal, and HOSTSIM_VCD=file
+ * records all 32 pins in a VCD file.
+ *
+ * @par Core Usage
+ * Simulates all 8 cogs.
+ *
+ * @par Memory Models
+ * Host computer only.
+ *
+ * @version
+ * 0.5
+ */
+
+#ifndef HOSTSIM_H
+#define HOSTSIM_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <propeller.h>
+
+/**
+ * @brief Simulated time in system clock ticks since the program started.
+ * CNT is the lower 32 bits.
+ */
+typedef unsigned long long sim_time_t;
+
+/**
+ * @brief Function called when pins on the simulated bus change.
+ *
+ * @param t Simulated time of the change.
+ * @param pins States of all 32 pins after the change.
+ * @param changed Bit set for each pin that changed.
+ */
+typedef void (*sim_watch_t)(sim_time_t t, unsigned int pins,
+                            unsigned int changed);
+
+/**
+ * @brief Function called with each WAITVID the cog emulator runs.
+ *
+ * @param cog Cog id.
+ * @param vscl VSCL: clocks per pixel in bits 19..12, per frame in 11..0.
+ * @param colors Colors (the WAITVID's destination).
+ * @param pixels Pixels (the WAITVID's source).
+ * @param late 1 if the video generator finished its last frame before
+ * this WAITVID, so the picture would have a gap.
+ */
+typedef void (*sim_video_t)(int cog, unsigned int vscl, unsigned int colors,
+                            unsigned int pixels, int late);
+
+/**
+ * @brief Get the current simulated time.
+ *
+ * @returns Clock ticks since the program started.
+ */
+sim_time_t sim_now(void);
+
+/**
+ * @brief Get the state of all 32 pins on the simulated bus.
+ *
+ * @returns P0 in bit 0 through P31 in bit 31.
+ */
+unsigned int sim_pins(void);
+
+/**
+ * @brief Set the clock ticks each cog register access takes.
+ *
+ * @param ticks Clock ticks (default 16).
+ */
+void sim_cost(int ticks);
+
+/**
+ * @brief Drive a pin from outside the Propeller.  Cogs that make the pin
+ * an output still win.
+ *
+ * @param pin Pin number (0 to 31).
+ * @param state 1 for high, 0 for low.
+ */
+void sim_input(int pin, int state);
+
+/**
+ * @brief Stop driving a pin from outside.  It returns to its pull-up
+ * state, or low if it has none.
+ *
+ * @param pin Pin number (0 to 31).
+ */
+void sim_float(int pin);
+
+/**
+ * @brief Connect or disconnect a pull-up resistor on a pin.
+ *
+ * @param pin Pin number (0 to 31).
+ * @param on 1 to pull up, 0 for none.
+ */
+void sim_pullup(int pin, int on);
+
+/**
+ * @brief Call a function each time pins change.
+ *
+ * @param fn Function to call.  It runs in the simulator with simulated
+ * time stopped, and can call sim_input, sim_float and sim_at.
+ *
+ * @returns 0 if added, -1 if too many watchers.
+ */
+int sim_watch(sim_watch_t fn);
+
+/**
+ * @brief Call a function with each frame of pixels emulated cogs hand the
+ * video generator.  The generator does not drive pins, so this is how a
+ * test sees a video driver's picture.
+ *
+ * @param fn Function to call, or NULL to stop.  It runs in the emulated
+ * cog, before the WAITVID waits.
+ */
+void sim_video_watch(sim_video_t fn);
+
+/**
+ * @brief Call a function at a certain simulated time.
+ *
+ * @param t Simulated time (from sim_now() + ticks).
+ * @param fn Function to call, with the same rules as sim_watch functions.
+ * @param arg Value to pass to the function.
+ */
+void sim_at(sim_time_t t, void (*fn)(void *arg), void *arg);
+
+/**
+ * @brief Run a C function in place of a PASM image.  cognew and coginit
+ * calls with that image start the function in a simulated cog, passing
+ * the PAR value.
+ *
+ * @param image Address of the PASM image (binary_..._dat_start symbol).
+ * @param fn Function to run, or NULL to run the image itself on the cog
+ * emulator again.
+ */
+void sim_driver(const void *image, void (*fn)(void *par));
+
+/**
+ * @brief Send bytes to a pin as asynchronous serial, the way a serial
+ * device connected to that pin would.  Bytes queue up behind any still
+ * being sent to the same pin.  Call sim_input(pin, 1) before the
+ * Propeller side opens the port, so it sees an idle line.
+ *
+ * @param pin Pin number (0 to 31).
+ * @param baud Bits per second.
+ * @param data Bytes to send.
+ * @param length Number of bytes.
+ */
+void sim_uart_send(int pin, int baud, const char *data, int length);
+
+/**
+ * @brief Receive asynchronous serial bytes that the Propeller transmits
+ * on a pin.
+ *
+ * @param pin Pin number (0 to 31).
+ * @param baud Bits per second.
+ * @param fn Function called with each byte.
+ *
+ * @returns 0 if added, -1 if too many receivers.
+ */
+int sim_uart_watch(int pin, int baud, void (*fn)(int pin, int byte));
+
+/**
+ * @brief Connect a simulated 24LC512-style I2C EEPROM (address 0xA0) to
+ * a pair of pins.  One is connected to P28/P29 at startup.
+ *
+ * @param sclPin Clock pin.
+ * @param sdaPin Data pin.
+ *
+ * @returns Address of its 65536 bytes, for tests to fill or check.
+ */
+unsigned char *sim_eeprom(int sclPin, int sdaPin);
+
+/**
+ * @brief Record pin changes in a Value Change Dump (VCD) file, with
+ * times in picoseconds.  Replaces any recording already going.
+ *
+ * @param file File name.
+ * @param mask Bit set for each pin to record.
+ *
+ * @returns 0 if recording, -1 if the file cannot be written.
+ */
+int sim_vcd_open(const char *file, unsigned int mask);
+
+/**
+ * @brief Stop recording pin changes and close the VCD file.  Files still
+ * open at exit are closed then.
+ */
+void sim_vcd_close(void);
+
+/**
+ * @brief Check WS2812 bit timing on a pin.  Each high pulse has to fit
+ * the 0 bit or the 1 bit window, and each frame (ended by 50 us or more
+ * low) has to be a whole number of 24-bit LEDs.  A frame is checked when
+ * the next one starts.
+ *
+ * @param pin Pin number (0 to 31).
+ * @param t0hMin Shortest 0 bit high time, in ns.
+ * @param t0hMax Longest 0 bit high time, in ns.
+ * @param t1hMin Shortest 1 bit high time, in ns.
+ * @param t1hMax Longest 1 bit high time, in ns.
+ *
+ * @returns Checker id, or -1 if too many checkers.
+ */
+int sim_check_ws2812(int pin, int t0hMin, int t0hMax, int t1hMin,
+                     int t1hMax);
+
+/**
+ * @brief Check hobby servo timing on a pin.  High pulses have to be 400
+ * to 2600 us, and start 19 to 21 ms after the one before.
+ *
+ * @param pin Pin number (0 to 31).
+ *
+ * @returns Checker id, or -1 if too many checkers.
+ */
+int sim_check_servo(int pin);
+
+/**
+ * @brief Get the number of pulses a checker has seen.
+ *
+ * @param id Checker id.
+ *
+ * @returns Pulses so far.
+ */
+int sim_check_count(int id);
+
+/**
+ * @brief Get the number of timing violations a checker has found.  The
+ * first few are also printed to standard error.
+ *
+ * @param id Checker id.
+ *
+ * @returns Violations so far.
+ */
+int sim_check_errors(int id);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // HOSTSIM_H
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,13 @@
+/**
+ * @file cog.h
+ *
+ * @brief Stands in for PropGCC's cog.h when building for the host with 
+ * libhostsim.
+ */
+
+#ifndef __COG_H__
+#define __COG_H__
+
+#include <propeller.h>
+
+#endif
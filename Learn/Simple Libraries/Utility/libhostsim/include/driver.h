@@ -0,0 +1,13 @@
+/**
+ * @file driver.h
+ *
+ * @brief Stands in for PropGCC's driver.h when building for the host with 
+ * libhostsim.  Host builds use the C library's own stdio drivers.
+ */
+
+#ifndef __DRIVER_H__
+#define __DRIVER_H__
+
+typedef struct __driver _Driver;
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file propeller.h
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Stands in for PropGCC's propeller.h when libraries are built for
+ * the host computer with libhostsim.  Cog registers, CNT, waitcnt, 
+ * waitpeq, waitpne, cogstart, cognew and locks go to the simulator in 
+ * hostsim.c instead of the hardware.
+ */
+
+#ifndef __PROPELLER_H__
+#define __PROPELLER_H__
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Register numbers for sim_reg */
+#define SIM_OUTA 0
+#define SIM_DIRA 1
+#define SIM_OUTB 2
+#define SIM_DIRB 3
+#define SIM_CTRA 4
+#define SIM_CTRB 5
+#define SIM_FRQA 6
+#define SIM_FRQB 7
+#define SIM_PHSA 8
+#define SIM_PHSB 9
+#define SIM_VCFG 10
+#define SIM_VSCL 11
+
+volatile unsigned int *sim_reg(int reg);
+unsigned int sim_ina(void);
+unsigned int sim_cnt(void);
+void sim_waitcnt(unsigned int target);
+unsigned int sim_waitcnt2(unsigned int target, unsigned int delta);
+void sim_waitpeq(unsigned int state, unsigned int mask);
+void sim_waitpne(unsigned int state, unsigned int mask);
+
+extern unsigned int _clkfreq;
+extern unsigned char _clkmode;
+
+#define CLKFREQ _clkfreq
+#define CLKMODE _clkmode
+
+#define INA   sim_ina()
+#define INB   0
+#define CNT   sim_cnt()
+#define OUTA  (*sim_reg(SIM_OUTA))
+#define DIRA  (*sim_reg(SIM_DIRA))
+#define OUTB  (*sim_reg(SIM_OUTB))
+#define DIRB  (*sim_reg(SIM_DIRB))
+#define CTRA  (*sim_reg(SIM_CTRA))
+#define CTRB  (*sim_reg(SIM_CTRB))
+#define FRQA  (*sim_reg(SIM_FRQA))
+#define FRQB  (*sim_reg(SIM_FRQB))
+#define PHSA  (*sim_reg(SIM_PHSA))
+#define PHSB  (*sim_reg(SIM_PHSB))
+#define VCFG  (*sim_reg(SIM_VCFG))
+#define VSCL  (*sim_reg(SIM_VSCL))
+
+#define HUBDATA
+#define HUBTEXT
+#define _COGMEM
+#define _NATIVE
+#define _NAKED
+#define _FCACHE
+
+#define waitcnt(a) sim_waitcnt(a)
+#define waitcnt2(a, b) sim_waitcnt2((a), (b))
+#define waitpeq(state, mask) sim_waitpeq((state), (mask))
+#define waitpne(state, mask) sim_waitpne((state), (mask))
+#define __builtin_propeller_waitcnt(a, b) sim_waitcnt2((a), (b))
+#define __builtin_propeller_waitpeq(state, mask) sim_waitpeq((state), (mask))
+#define __builtin_propeller_waitpne(state, mask) sim_waitpne((state), (mask))
+
+/**
+ * @brief Stand-in for the thread state PropGCC keeps at the top of a 
+ * cogstart stack.
+ */
+typedef struct _thread_state_s { int regs[44]; } _thread_state_t;
+
+int cogstart(void (*func)(void *), void *par, void *stack, size_t stacksize);
+int coginit(int id, void *code, void *par);
+int cogid(void);
+int _coginit(int par, int code, int id);
+void cogstop(int id);
+int locknew(void);
+void lockret(int id);
+int lockset(int id);
+int lockclr(int id);
+void clkset(int mode, int frequency);
+
+#define cognew(code, par) coginit(0x8, (code), (par))
+#define __builtin_propeller_cogid() cogid()
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // __PROPELLER_H__
@@ -0,0 +1,11 @@
+/**
+ * @file sd.h
+ *
+ * @brief Stands in for PropGCC's sys/sd.h when building for the host with
+ * libhostsim.  SD card mounting (sd_mount) is not simulated.
+ */
+
+#ifndef __SYS_SD_H__
+#define __SYS_SD_H__
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ * @file unistd.h
+ *
+ * @brief Wraps the host's unistd.h so its pause() does not collide with 
+ * simpletools' pause(int time) when building with libhostsim.
+ */
+
+#ifndef HOSTSIM_UNISTD_H
+#define HOSTSIM_UNISTD_H
+
+#define pause hostsim_libc_pause
+#include_next <unistd.h>
+#undef pause
+
+#endif
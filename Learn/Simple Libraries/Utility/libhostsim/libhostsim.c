@@ -0,0 +1,795 @@
+/*
+ * @file libhostsim.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Test harness for libhostsim.  Runs unmodified simpletools,
+ * simpletext, fdserial, gps, servo, datetime, tasks, ws2812, vgatext and vgatile code, and
+ * the fdserial, ws2812 and VGA PASM drivers, against the simulator and checks the results and
+ * their pin timing.  Build and run with make test.
+ */
+
+#include "simpletools.h"
+#include "fdserial.h"
+#include "gps.h"
+#include "ws2812.h"
+#include "servo.h"
+#include "datetime.h"
+#include "vgatext.h"
+#include "vgatile.h"
+#include "tasks.h"
+#include "hostsim.h"
+
+static int fails;
+
+static void check(const char *name, int ok)
+{
+  print("%s %s\n", ok ? "PASS" : "FAIL", name);
+  if(!ok) fails++;
+}
+
+// Two cog_run stacks of 64 ints, one after the other
+MEM_POOL(runStacks, 64 + 4 + 176 + 64 * 4, 2);
+
+static volatile int counted;
+
+static void counter(void *par)
+{
+  while(1)
+  {
+    counted++;
+    pause(1);
+  }
+}
+
+// Tasks A, B and C, listed in that order: each turn, A stops B and starts
+// it again, which moves B to the front of the list
+static task_t taskA, taskB, taskC;
+static int taskRuns[3];
+
+TASK(task_b)
+{
+  task_begin();
+  while(1)
+  {
+    taskRuns[1]++;
+    task_yield();
+  }
+  task_end();
+}
+
+TASK(task_a)
+{
+  task_begin();
+  while(1)
+  {
+    taskRuns[0]++;
+    task_stop(&taskB);
+    task_start(&taskB, task_b, NULL);
+    task_yield();
+  }
+  task_end();
+}
+
+TASK(task_c)
+{
+  task_begin();
+  while(1)
+  {
+    taskRuns[2]++;
+    task_yield();
+  }
+  task_end();
+}
+
+// pwm_multi edge timing on P24-P27: shortest and longest high times and
+// periods once the pins are running
+static const int pwmPin[4] = {24, 25, 26, 27};
+static int pwmWatching, pwmEdges;
+static sim_time_t pwmRise[4];
+static int pwmHigh[4][2], pwmPeriod[4][2];
+
+static void pwm_watch(sim_time_t t, unsigned int pins, unsigned int changed)
+{
+  if(!pwmWatching) return;
+  for(int i = 0; i < 4; i++)
+  {
+    unsigned int mask = 1 << pwmPin[i];
+    if(!(changed & mask)) continue;
+    pwmEdges++;
+    int *range = pwmHigh[i];
+    int ticks = (int) (t - pwmRise[i]);
+    if(pins & mask)
+    {
+      range = pwmPeriod[i];
+      pwmRise[i] = t;
+    }
+    if(pwmWatching++ < 16) continue;           // Let every pin start first
+    if(ticks < range[0]) range[0] = ticks;
+    if(ticks > range[1]) range[1] = ticks;
+  }
+}
+
+static void pin13_low(void *arg)
+{
+  sim_input(13, 0);
+}
+
+static char rxText[16];
+static int rxCount;
+
+static void rx_byte(int pin, int byte)
+{
+  if(rxCount < (int) sizeof(rxText) - 1) rxText[rxCount++] = byte;
+}
+
+static const int ledPin[4] = {9, 24, 25, 26}; // WS2812 data line decoder
+static sim_time_t ledRise[4];
+static int ledBits[4], ledShortest = 1 << 30, ledLongest;
+static unsigned int ledData[4][2];
+static unsigned int ledShown[2];               // P9's last whole 2 LED frame
+
+static void led_watch(sim_time_t t, unsigned int pins, unsigned int changed)
+{
+  for(int i = 0; i < 4; i++)
+  {
+    unsigned int mask = 1 << ledPin[i];
+    if(!(changed & mask)) continue;
+    if(pins & mask)
+    {
+      ledRise[i] = t;
+      continue;
+    }
+    int high = (int) (t - ledRise[i]);
+    if(high < ledShortest) ledShortest = high;
+    if(high > ledLongest) ledLongest = high;
+    unsigned int *led = &ledData[i][ledBits[i]++ / 24 & 1];  // The last 2 LEDs
+    *led = ((*led << 1) | (high > 50)) & 0xFFFFFF;
+    if(i == 0 && !(ledBits[0] % 48))
+      memcpy(ledShown, ledData[0], sizeof(ledShown));
+  }
+}
+
+// Edges on P10-P16, the pins next to P9 that parallel strips would use
+static int stripEdges;
+
+static void strip_watch(sim_time_t t, unsigned int pins, unsigned int changed)
+{
+  if(changed & 0x1FC00) stripEdges++;
+}
+
+// APA102 decoder: data on P14 read at each rising edge of the clock on P15
+static sim_time_t apaRise;
+static int apaBits, apaPeriod = 1 << 30;
+static unsigned int apaWord[4], apaLed;      // and the last LED's
+
+static void apa_watch(sim_time_t t, unsigned int pins, unsigned int changed)
+{
+  if(!(changed & pins & (1 << 15))) return;
+  if(apaBits && (int) (t - apaRise) < apaPeriod) apaPeriod = (int) (t - apaRise);
+  apaRise = t;
+  unsigned int *word = &apaWord[apaBits++ / 32 & 3];
+  *word = (*word << 1) | (pins >> 14 & 1);
+  if(!(apaBits & 31) && *word >> 29 == 7) apaLed = *word;
+}
+
+// The driver packs the colors' address into 16 bits, so keep them in the
+// driver state's 64 KB block, below $8000 (see hostsim.h)
+static struct
+{
+  ws2812_t strip;
+  uint32_t leds[2];
+  ws2812_frame_t frame;
+  uint32_t frameLeds[2][2];
+  uint32_t strips[3][2];
+  ws2812_cmd_t cmd;
+  uint32_t chain[300];
+  uint16_t levels[256];
+  ws2812_anim_t anim;
+  uint32_t animLeds[2][2];
+} ledHub __attribute__((aligned(65536)));
+
+// vgatile: the tile frames (16 pixels, 1 clock each) of one whole frame
+static volatile int vidGrab, vidLine, vidCol, vidLate;
+static unsigned int vidPixels[VGA_TILE_ROWS * VGA_TILE_HEIGHT][VGA_TILE_COLS];
+static unsigned int vidColors[VGA_TILE_COLS];
+
+static void tile_video(int cog, unsigned int vscl, unsigned int colors,
+                       unsigned int pixels, int late)
+{
+  extern volatile vgatiledev_t gVgaTile;
+  static int frame;
+  if(vidGrab == 1 && gVgaTile.frame != frame)  // Counted before line 0
+  {
+    vidGrab = 2;
+    vidLine = vidCol = vidLate = 0;
+  }
+  frame = gVgaTile.frame;
+  if(vidGrab != 2) return;
+  vidLate += late;
+  if(vscl != (1 << 12 | 16)) return;
+  if(vidLine == 0) vidColors[vidCol] = colors;
+  vidPixels[vidLine][vidCol] = pixels;
+  if(++vidCol < VGA_TILE_COLS) return;
+  vidCol = 0;
+  if(++vidLine == VGA_TILE_ROWS * VGA_TILE_HEIGHT) vidGrab = 0;
+}
+
+static void tile_grab(void)
+{
+  vidGrab = 1;
+  while(vidGrab) pause(1);
+}
+
+int main()
+{
+  // Simulated time: pause(100) should take 100 ms of CNT ticks
+  int t = CNT;
+  pause(100);
+  int dt = CNT - t;
+  check("pause(100) takes 100 ms", dt >= CLKFREQ / 10 && dt < CLKFREQ / 10 + 1000);
+
+  // Cogs: a cog_run cog counts while main spins on a hub variable
+  int *cog = cog_run(counter, 64);
+  while(counted < 20);
+  cog_end(cog);
+  check("cog_run cog runs alongside main", counted >= 20);
+
+  // Painting a cog_run stack for the stack monitor stays inside its block
+  stack_monitor_start();
+  int *runA = cog_run(counter, 64);
+  int *runB = cog_run(counter, 64);
+  int runCog = *runB;
+  cog_end(runA);
+  runA = cog_run(counter, 64);
+  check("cog_run paints adjacent stacks", runB == runA + 125 &&
+        *runB == runCog && stack_monitor_size(0) == 124 &&
+        stack_monitor_used(0) == 0);
+  cog_end(runA);
+  cog_end(runB);
+  runA = cog_run(counter, 64);                // Both back from the pool
+  runB = cog_run(counter, 64);
+  check("cog_end returns blocks to the pool", runStacks.used == 2 &&
+        runStacks.highWater == 2);
+  cog_end(runA);
+  cog_end(runB);
+
+  // A task that stops the next one in line does not send task_step to it
+  task_start(&taskC, task_c, NULL);
+  task_start(&taskB, task_b, NULL);
+  task_start(&taskA, task_a, NULL);
+  int taskRan = task_step();
+  check("task_step after a task stops the next", taskRan == 2 &&
+        taskRuns[0] == 1 && taskRuns[1] == 0 && taskRuns[2] == 1);
+  task_stop(&taskA);
+  task_stop(&taskB);
+  task_stop(&taskC);
+
+  // Counter modules: pwm cog drives P5, pulse_in measures it
+  pwm_start(1000);
+  pwm_set(5, 0, 250);
+  long us = pulse_in(5, 1);
+  pwm_stop();
+  check("pwm high time read by pulse_in", us >= 249 && us <= 251);
+
+  // Starting pwm or datetime again stops the running cog before its stack
+  // is painted for the stack monitor, so only one is left to stop
+  pwm_start(1000);
+  pwm_set(5, 0, 250);
+  pwm_start(1000);
+  pwm_stop();
+  int pwmLeft = count(5, 10);
+  dt_run(dt_fromEt(1000));
+  dt_run(dt_fromEt(1000));
+  dt_end();
+  int et = dt_toEt(dt_get());
+  pause(2000);
+  check("pwm and datetime restart their one cog", pwmLeft == 0 &&
+        dt_toEt(dt_get()) == et);
+
+  // pwm_multi at 10, 25, 50 and 90 percent of 1 ms: high times and periods
+  // stay within the lateness the cog reports
+  sim_watch(pwm_watch);
+  pwm_multi_start();
+  pwm_multi_group(0, 1000);
+  static const int pwmDuty[4] = {10, 25, 50, 90};
+  for(int i = 0; i < 4; i++)
+  {
+    pwm_multi_pin(pwmPin[i], 0, 100);
+    pwm_multi_set(pwmPin[i], pwmDuty[i]);
+    pwmHigh[i][0] = pwmPeriod[i][0] = 1 << 30;
+  }
+  pwm_multi_commit();
+  pwmWatching = 1;
+  pause(20);
+  pwmWatching = 0;
+  int pwmOk = 1, pwmSpread = 0;
+  for(int i = 0; i < 4; i++)
+  {
+    int high = CLKFREQ / 1000 * pwmDuty[i] / 100;
+    pwmOk &= pwmHigh[i][0] >= high - 80 && pwmHigh[i][1] <= high + 80 &&
+             pwmPeriod[i][0] >= CLKFREQ / 1000 - 80 &&
+             pwmPeriod[i][1] <= CLKFREQ / 1000 + 80;
+    if(pwmHigh[i][1] - pwmHigh[i][0] > pwmSpread)
+      pwmSpread = pwmHigh[i][1] - pwmHigh[i][0];
+    if(pwmPeriod[i][1] - pwmPeriod[i][0] > pwmSpread)
+      pwmSpread = pwmPeriod[i][1] - pwmPeriod[i][0];
+  }
+  check("pwm_multi edge jitter", pwmOk &&
+        pwmSpread <= (int) pwm_multi_jitter() + 80);
+
+  // A restarted pwm_multi cog waits for a commit, not the last schedule (a
+  // 50 ms one here, that would hold off the next commit until it ended)
+  pwm_multi_group(0, 50000);
+  pwm_multi_commit();
+  pwm_multi_commit();                         // Returns once the cog has it
+  pwm_multi_stop();
+  pwm_multi_start();
+  pwm_multi_group(0, 1000);
+  pwmEdges = 0;
+  pwmWatching = 1;
+  pause(5);
+  int pwmIdle = pwmEdges;
+  pwm_multi_commit();
+  pause(5);
+  pwmWatching = 0;
+  pwm_multi_stop();
+  check("pwm_multi restarts without a schedule", pwmIdle == 0 &&
+        pwmEdges >= 4 * 2 * 4);
+
+  // NCO output counted by an edge detector
+  square_wave(6, 0, 1000);
+  int edges = count(6, 100);
+  square_wave_stop();
+  check("square_wave counted by count", edges >= 99 && edges <= 101);
+
+  // I2C EEPROM on P28/P29
+  ee_putInt(123456, 32768);
+  check("EEPROM write and read back", ee_getInt(32768) == 123456);
+
+  // fdserial through the C stand-in for its PASM driver; the simulated
+  // device idles its line high before the port opens
+  sim_input(1, 1);
+  fdserial *port = fdserial_open(1, 2, 0, 115200);
+  sim_uart_watch(2, 115200, rx_byte);
+  sim_uart_send(1, 115200, "hi", 2);
+  int a = fdserial_rxChar(port);
+  int b = fdserial_rxChar(port);
+  dprint(port, "ok");
+  fdserial_txFlush(port);
+  pause(1);
+  fdserial_close(port);
+  check("fdserial receive", a == 'h' && b == 'i');
+  check("fdserial transmit", !strcmp(rxText, "ok"));
+
+  // gps library parsing a sentence sent at 9600 baud
+  const char *rmc = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,"
+                    "230394,003.1,W*6A\r\n";
+  sim_input(3, 1);
+  gps_open(3, 4, 9600);
+  pause(600);                                 // gps cog's fdserial_open
+  sim_uart_send(3, 9600, rmc, strlen(rmc));
+  pause(200);
+  float lat = gps_latitude();
+  check("gps latitude", gps_fixValid() && lat > 48.11 && lat < 48.12);
+  sim_uart_send(3, 9600, rmc, strlen(rmc));   // gps cog checks for close
+  gps_close();                                // after each byte
+
+  // fdserial on its own PASM driver, run by the cog emulator
+  extern unsigned int binary_pst_dat_start[];
+  sim_driver(binary_pst_dat_start, NULL);
+  rxCount = 0;
+  memset(rxText, 0, sizeof(rxText));
+  sim_input(7, 1);
+  port = fdserial_open(7, 8, 0, 115200);
+  sim_uart_watch(8, 115200, rx_byte);
+  sim_uart_send(7, 115200, "pasm", 4);
+  char got[5] = {0};
+  for(int i = 0; i < 4; i++) got[i] = fdserial_rxChar(port);
+  dprint(port, "cog");
+  fdserial_txFlush(port);
+  pause(1);
+  fdserial_close(port);
+  check("PASM fdserial receive", !strcmp(got, "pasm"));
+  check("PASM fdserial transmit", !strcmp(rxText, "cog"));
+
+  // CMPSUB in the cog emulator: Z is D == S and C is D >= S, whether or not
+  // S is taken.  The cog writes Z and C (bits 0 and 1) to PAR.
+  static unsigned int cmpsubCog[496] = {
+    0xE3FC0A05,                               // cmpsub  5, #5 wz wc
+    0x78FC0C01,                               // muxz    6, #1
+    0x70FC0C02,                               // muxc    6, #2
+    0x083C0DF0,                               // wrlong  6, par
+    0x5C7C0004,                               // jmp     #$
+  };
+  static volatile int cmpsubFlags[3];
+  static const unsigned int cmpsubD[3] = {0, 5, 7};
+  for(int i = 0; i < 3; i++)
+  {
+    cmpsubCog[5] = cmpsubD[i];
+    cmpsubFlags[i] = -1;
+    int id = cognew(cmpsubCog, (void *) &cmpsubFlags[i]);
+    while(cmpsubFlags[i] < 0) pause(1);
+    cogstop(id);
+  }
+  check("PASM CMPSUB flags", cmpsubFlags[0] == 0 && cmpsubFlags[1] == 3 &&
+        cmpsubFlags[2] == 2);
+
+  // ws2812 PASM driver on P9: 0 bits are set for 28 ticks high and 1 bits
+  // for 72; the driver's loop adds 6 and 10 (a skipped WAITCNT)
+  sim_watch(led_watch);
+  int ledCheck = sim_check_ws2812(9, 200, 500, 750, 1050);
+  sim_vcd_open("build/ws2812.vcd", 1 << 9);
+  ws2812b_start(&ledHub.strip);
+  ledHub.leds[0] = COLOR_RED;
+  ledHub.leds[1] = COLOR_BLUE;
+  ws2812_set(&ledHub.strip, 9, ledHub.leds, 2);
+  unsigned int ledId = ws2812_set(&ledHub.strip, 11, ledHub.leds, 2);
+  int ledQueued = mailbox_pending(&ledHub.strip.box);
+  ws2812_wait(&ledHub.strip, ledId);
+  ws2812_stop(&ledHub.strip);
+  check("ws2812 mailbox queues requests", ledQueued == 2 &&
+        ledHub.strip.box.counted == 2 &&
+        ledHub.strip.box.latencyMax > 2 * 48 * 100);
+  check("ws2812 sends GRB data", ledBits[0] == 48 &&
+        ledData[0][0] == 0x00FF00 && ledData[0][1] == 0x0000FF);
+  check("ws2812 high times", ledShortest == 34 && ledLongest == 82);
+  sim_vcd_close();
+  check("ws2812 timing checker", sim_check_count(ledCheck) == 48 &&
+        sim_check_errors(ledCheck) == 0);
+  FILE *vcd = fopen("build/ws2812.vcd", "r");
+  char line[80];
+  int stamps = 0;
+  while(vcd && fgets(line, sizeof(line), vcd)) stamps += line[0] == '#';
+  if(vcd) fclose(vcd);
+  check("ws2812 VCD capture", stamps == 1 + 2 * 48);
+
+  // Double-buffered frames: a frame committed while the last one is still
+  // going out waits, and is dropped if the next frame begins first
+  ws2812_frame_t *ledFrame = &ledHub.frame;
+  ws2812b_start(&ledHub.strip);
+  ws2812_frame_init(ledFrame, &ledHub.strip, 9, ledHub.frameLeds[0],
+                    ledHub.frameLeds[1], 2);
+  uint32_t *draw[3];
+  int sent[3];
+  const uint32_t frameColor[3] = {COLOR_RED, COLOR_GREEN, COLOR_BLUE};
+  for(int i = 0; i < 3; i++)
+  {
+    draw[i] = ws2812_begin_frame(ledFrame);
+    draw[i][0] = draw[i][1] = frameColor[i];
+    sent[i] = ws2812_commit(ledFrame);
+  }
+  ws2812_flush(ledFrame);
+  ws2812_stop(&ledHub.strip);
+  check("ws2812 frames swap buffers and drop stale ones",
+        sent[0] && !sent[1] && !sent[2] && draw[1] != draw[0] &&
+        draw[2] == draw[1] && ledFrame->frames == 2 && ledFrame->dropped == 1 &&
+        ledBits[0] == 48 + 2 * 48 && ledData[0][0] == 0x0000FF &&
+        ledData[0][1] == 0x0000FF && sim_check_errors(ledCheck) == 0);
+
+  // Parallel strips on P24-P26: each strip's own colors, bits sent together
+  int stripCheck[3];
+  for(int i = 0; i < 3; i++)
+    stripCheck[i] = sim_check_ws2812(24 + i, 200, 500, 750, 1050);
+  const uint32_t stripColor[3][2] = {{COLOR_RED, COLOR_GREEN},
+                                     {COLOR_BLUE, COLOR_WHITE},
+                                     {COLOR(1, 2, 3), COLOR_BLACK}};
+  const unsigned int stripGrb[3][2] = {{0x00FF00, 0xFF0000},
+                                       {0x0000FF, 0xFFFFFF},
+                                       {0x020103, 0x000000}};
+  memcpy(ledHub.strips, stripColor, sizeof(stripColor));
+  memset(ledBits, 0, sizeof(ledBits));
+  ws2812b_start(&ledHub.strip);
+  ledId = ws2812_set_parallel(&ledHub.strip, 24, 3, ledHub.strips[0], 2);
+  ws2812_wait(&ledHub.strip, ledId);
+  unsigned int parallelTicks = ledHub.strip.box.latencyMax;
+  ws2812_stop(&ledHub.strip);
+  int stripsOk = 1;
+  for(int i = 0; i < 3; i++)
+    stripsOk &= ledBits[i + 1] == 48 && ledData[i + 1][0] == stripGrb[i][0] &&
+                ledData[i + 1][1] == stripGrb[i][1] &&
+                sim_check_errors(stripCheck[i]) == 0;
+  check("ws2812 parallel strips", stripsOk);
+  check("ws2812 parallel beats one strip at a time",   // 100 ticks a bit
+        parallelTicks < 3 * 48 * 100);
+
+  // A 300 LED chain in one request, passed by descriptor
+  for(int i = 0; i < 300; i++) ledHub.chain[i] = COLOR(i & 255, i >> 8, 7);
+  ledHub.cmd.count = 300;
+  ledHub.cmd.pin = 9;
+  ledHub.cmd.strips = 1;
+  ledHub.cmd.flags = 0;
+  ledHub.cmd.colors = ledHub.chain;
+  int chainStart = sim_check_count(ledCheck);
+  ledBits[0] = 0;
+  ws2812b_start(&ledHub.strip);
+  ledId = ws2812_send(&ledHub.strip, &ledHub.cmd);
+  ws2812_wait(&ledHub.strip, ledId);
+  unsigned int chainTicks = ledHub.strip.box.latencyLast;
+  ws2812_stop(&ledHub.strip);
+  check("ws2812 descriptor sends a long chain",     // 126 ticks a bit
+        ledBits[0] == 300 * 24 && ledData[0][0] == 0x012A07 &&
+        ledData[0][1] == 0x012B07 &&
+        sim_check_count(ledCheck) - chainStart == 300 * 24 &&
+        sim_check_errors(ledCheck) == 0 && chainTicks < 300 * 24 * 130);
+
+  // A descriptor with no LEDs finishes without sending, and strips outside
+  // 1 to WS2812_STRIPS are clamped, so 0 strips sends only P9's chain
+  sim_watch(strip_watch);
+  ledBits[0] = 0;
+  ws2812b_start(&ledHub.strip);
+  ledHub.cmd.count = 0;
+  ws2812_wait(&ledHub.strip, ws2812_send(&ledHub.strip, &ledHub.cmd));
+  int emptyBits = ledBits[0];
+  ledHub.cmd.count = 2;
+  ledHub.cmd.strips = 0;
+  stripEdges = 0;
+  ws2812_wait(&ledHub.strip, ws2812_send(&ledHub.strip, &ledHub.cmd));
+  ws2812_stop(&ledHub.strip);
+  check("ws2812 descriptor count and strips limits", emptyBits == 0 &&
+        ledBits[0] == 2 * 24 && stripEdges == 0);
+  ledHub.cmd.count = 300;
+  ledHub.cmd.strips = 1;
+
+  // Levels looked up by the driver: at half brightness red 255 is 128, and
+  // blue 1 is 0.5, dithered to 1 in half of 8 frames
+  ws2812b_start(&ledHub.strip);
+  ws2812_gamma(&ledHub.strip, ledHub.levels, 10);
+  ws2812_brightness(&ledHub.strip, 128);
+  ledHub.leds[0] = ledHub.leds[1] = COLOR(255, 0, 1);
+  int blueSum = 0, halfRed = 1;
+  for(int i = 0; i < 8; i++)
+  {
+    ws2812_wait(&ledHub.strip, ws2812_set(&ledHub.strip, 9, ledHub.leds, 2));
+    blueSum += (ledData[0][0] & 0xFF) + (ledData[0][1] & 0xFF);
+    halfRed &= ledData[0][0] >> 8 == 128 && ledData[0][1] >> 8 == 128;
+  }
+  check("ws2812 brightness and dithering", halfRed && blueSum == 2 * 4);
+  ws2812_gamma(&ledHub.strip, ledHub.levels, 22);   // 255 * 0.5^2.2 is 55.4
+  ws2812_brightness(&ledHub.strip, 255);
+  ledHub.leds[0] = ledHub.leds[1] = COLOR(128, 0, 0);
+  ws2812_wait(&ledHub.strip, ws2812_set(&ledHub.strip, 9, ledHub.leds, 2));
+  ws2812_stop(&ledHub.strip);
+  check("ws2812 gamma", ledData[0][0] >> 8 >= 54 && ledData[0][0] >> 8 <= 60 &&
+        sim_check_errors(ledCheck) == 0);
+
+  // Animation engine at 1000 frames a second: a red fill, then a blue dot
+  // chasing itself around 2 LEDs, so they swap every frame.  The checks read
+  // the last whole frame, since main can wake up while one is going out.
+  ws2812_anim_t *anim = &ledHub.anim;
+  ledBits[0] = 0;
+  ws2812_effect_t effect = {WS2812_FILL, COLOR_RED, COLOR_BLACK, 1, 1, 1};
+  ws2812b_start(&ledHub.strip);
+  int animBad = ws2812_anim_start(anim, &ledHub.strip, 9, ledHub.animLeds[0],
+                                  ledHub.animLeds[1], 2, 0) == -1 &&
+                ws2812_anim_start(anim, &ledHub.strip, 9, ledHub.animLeds[0],
+                                  ledHub.animLeds[1], 0, 1000) == -1;
+  ws2812_anim_start(anim, &ledHub.strip, 9, ledHub.animLeds[0],
+                    ledHub.animLeds[1], 2, 1000);
+  mailbox_wait(&anim->box, ws2812_anim_post(anim, &effect));
+  pause(5);
+  unsigned int fillGrb[2] = {ledShown[0], ledShown[1]};
+  effect.effect = WS2812_CHASE;
+  effect.color = COLOR_BLUE;
+  mailbox_wait(&anim->box, ws2812_anim_post(anim, &effect));
+  pause(5);
+  unsigned int chaseGrb[2] = {ledShown[0], ledShown[1]};
+  int animStack = -1;
+  for(int id = 0; id < STACK_MONITOR_MAX; id++)
+  {
+    const char *name = stack_monitor_name(id);
+    if(name && !strcmp(name, "ws2812_anim")) animStack = id;
+  }
+  int animInts = stack_monitor_size(animStack);
+  ws2812_anim_stop(anim);
+  ws2812_stop(&ledHub.strip);
+  check("ws2812 animation engine", fillGrb[0] == 0x00FF00 &&
+        fillGrb[1] == 0x00FF00 && (chaseGrb[0] ^ chaseGrb[1]) == 0x0000FF &&
+        anim->cog == -1 && anim->frame.frames > 5 &&
+        sim_check_errors(ledCheck) == 0);
+  check("ws2812 animation engine arguments and stack", animBad &&
+        animInts == sizeof(anim->stack) / 4 && !stack_monitor_name(animStack));
+
+  // APA102 chain on P14 with its clock on P15: a start frame of zeros, each
+  // LED's brightness then blue, green, red, and 32 + 1 zero bits to end
+  sim_watch(apa_watch);
+  apa102_start(&ledHub.strip, 15, 1000000);
+  apa102_brightness(&ledHub.strip, 16);
+  ledHub.leds[0] = COLOR_RED;
+  ledHub.leds[1] = COLOR(1, 2, 3);
+  ws2812_wait(&ledHub.strip, ws2812_set(&ledHub.strip, 14, ledHub.leds, 2));
+  ws2812_stop(&ledHub.strip);
+  check("apa102 frame, colors and brightness", apaBits == 32 + 64 + 33 &&
+        apaWord[0] == 0 && apaWord[1] == 0xF00000FF &&
+        apaWord[2] == 0xF0030201 && apaWord[3] == 0 &&
+        apaPeriod == CLKFREQ / 1000000);
+  apaBits = 0;
+  apaPeriod = 1 << 30;
+  apa102_start(&ledHub.strip, 15, 0);
+  ledHub.cmd.pin = 14;
+  ws2812_wait(&ledHub.strip, ws2812_send(&ledHub.strip, &ledHub.cmd));
+  unsigned int apaTicks = ledHub.strip.box.latencyLast;
+  ws2812_stop(&ledHub.strip);
+  check("apa102 streams a long chain flat out",   // 24 ticks a bit
+        apaBits == 32 + 300 * 32 + 32 + 150 && apaPeriod == 24 &&
+        apaLed == 0xFF07012B &&
+        apaTicks < 300 * 32 * 30);
+
+  // Servo pulses and 20 ms frames on P10
+  int servoCheck = sim_check_servo(10);
+  servo_angle(10, 900);
+  pause(100);
+  servo_stop();
+  check("servo timing checker", sim_check_count(servoCheck) >= 4 &&
+        sim_check_errors(servoCheck) == 0);
+
+  // Pin events: one subscriber for P12 and P13, another for P13 only
+  static pin_event_t evBufA[8], evBufB[8];
+  static pin_events_t evA, evB;
+  sim_input(12, 0);
+  sim_input(13, 0);
+  pin_events_subscribe(&evA, (1 << 12) | (1 << 13), evBufA, 8);
+  pin_events_subscribe(&evB, 1 << 13, evBufB, 8);
+  pause(1);
+  sim_input(12, 1);
+  pause(1);
+  sim_input(13, 1);
+  pause(1);
+  sim_input(12, 0);
+  pause(1);
+  pin_event_t ev[4];
+  int evCount = pin_events_getBatch(&evA, ev, 4);
+  int evGap = ev[1].time - ev[0].time;
+  check("pin events in order with times", evCount == 3 &&
+        ev[0].pin == 12 && ev[0].edge == 1 && ev[1].pin == 13 &&
+        ev[1].edge == 1 && ev[2].pin == 12 && ev[2].edge == 0 &&
+        evGap > CLKFREQ / 1000 - 200 && evGap < CLKFREQ / 1000 + 200);
+  pin_events_wait(&evB, &ev[0]);
+  check("pin events per subscriber", ev[0].pin == 13 &&
+        pin_events_count(&evB) == 0 && evA.dropped == 0);
+  sim_at(sim_now() + CLKFREQ / 500, pin13_low, NULL);
+  pin_events_wait(&evB, &ev[0]);
+  int evLate = CNT - ev[0].time;
+  check("pin events wait wakes within its backoff", ev[0].pin == 13 && ev[0].edge == 0 &&
+        evLate >= 0 && evLate <= CLKFREQ / 10000 + 1000);
+  pin_events_unsubscribe(&evA);
+  pin_events_unsubscribe(&evB);
+
+  // fdserial's PASM image kept in EEPROM, its hub RAM overwritten through
+  // mem_get, then read back for fdserial_open
+  extern unsigned int binary_pst_dat_end[];
+  int imageBytes = (char *) binary_pst_dat_end - (char *) binary_pst_dat_start;
+  int freed = cog_imageStore(binary_pst_dat_start, imageBytes, 40000);
+  void *block = mem_get(freed);
+  check("cog image hub RAM freed", freed > 0 && freed == (imageBytes & ~3) &&
+        block == (void *) binary_pst_dat_start);
+  memset(block, 0, freed);
+  mem_put(block);
+  rxCount = 0;
+  memset(rxText, 0, sizeof(rxText));
+  port = fdserial_open(7, 8, 0, 115200);
+  sim_uart_send(7, 115200, "ee", 2);
+  memset(got, 0, sizeof(got));
+  for(int i = 0; i < 2; i++) got[i] = fdserial_rxChar(port);
+  dprint(port, "rom");
+  fdserial_txFlush(port);
+  pause(1);
+  fdserial_close(port);
+  check("fdserial from EEPROM image", !strcmp(got, "ee") &&
+        !strcmp(rxText, "rom"));
+
+  // An image that ends part way through a long frees only its whole longs,
+  // and loads into a block that holds all of it
+  static unsigned char oddImage[12] = "cog image!";
+  int oddFreed = cog_imageStore(oddImage, 10, 44000);
+  unsigned char *oddCode = cog_imageLoad(oddImage);
+  check("cog image of part of a long", oddFreed == 8 && oddCode &&
+        oddCode != oddImage && !memcmp(oddCode, "cog image!", 10));
+  mem_put(oddCode);
+
+  // vgatext scrolls 16 lines of text on 14 rows by moving the VGA driver's
+  // top row, and the cursor stays on the last row
+  extern short gVgaScreen[];
+  extern volatile vgatextdev_t gVgaText;
+  vgatext *vga = vgatext_open(16);
+  for(int i = 0; i < VGA_TEXT_ROWS + 2; i++) dprint(vga, "%c\n", 'a' + i);
+  short tile = gVgaScreen[(VGA_TEXT_ROWS - 2 + 3) % VGA_TEXT_ROWS * VGA_TEXT_COLS];
+  pause(20);
+  check("vgatext scrolls with the driver's top row", gVgaText.top == 3 &&
+        vgatext_getY() == VGA_TEXT_ROWS - 1 &&
+        tile == 0x200 + 'a' + VGA_TEXT_ROWS + 1 &&
+        gVgaText.status != VGA_TEXT_STAT_DISABLED);
+
+  // ANSI escape sequences: erase, move, color and a scroll region
+  #define VGA_AT(r, c) gVgaScreen[((r) + gVgaText.top) % VGA_TEXT_ROWS * \
+                                  VGA_TEXT_COLS + (c)]
+  dprint(vga, "\033[2J\033[3;5HX\033[1A\033[2DY\033[31mZ\033[0m");
+  check("vgatext ANSI cursor and colors", VGA_AT(2, 4) == 0x200 + 'X' &&
+        VGA_AT(1, 3) == (1 << 10) + 0x200 + 'Y' - 1 &&
+        VGA_AT(1, 4) == (12 << 10) + 0x200 + 'Z' && VGA_AT(0, 0) == 0x220);
+  // red on blue is magenta/black (2), not blue's own index (7), and
+  // dropping the background goes back to red (6)
+  dprint(vga, "\033[4;1H\033[31m\033[44mV\033[49mU\033[0m");
+  check("vgatext ANSI foreground and background combine",
+        VGA_AT(3, 0) == (4 << 10) + 0x200 + 'V' &&
+        VGA_AT(3, 1) == (13 << 10) + 0x200 + 'U' - 1);
+  dprint(vga, "\033[2;3r\033[3;1HA\nB\n\033[r");
+  check("vgatext ANSI scroll region", VGA_AT(1, 0) == 0x200 + 'B' &&
+        VGA_AT(2, 0) == 0x220 && VGA_AT(0, 0) == 0x220 &&
+        gVgaText.top == 3);
+  vgatext_close(vga);
+
+  // vgatile: the driver counts frames, ORs sprites onto the tiles line by
+  // line, clipped at the screen's edges, and keeps up with the video
+  // generator while it does
+  static const int dot[3] = {0x55555555, 0xAAAAAAAA, 0xFFFFFFFF};
+  static int bar[20];
+  memset(bar, 0xFF, sizeof(bar));
+  extern short gVgaTileScreen[2][VGA_TILE_SCREENSIZE];
+  vgatile *tiles = vgatile_open(16);
+  int frame = vgatile_frame();
+  pause(100);
+  frame = vgatile_frame() - frame;
+  check("vgatile counts frames", frame >= 5 && frame <= 7);
+  sim_video_watch(tile_video);
+  vgatile_setSprite(0, 20, 37, 3, dot);
+  vgatile_setSprite(1, -8, 470, 20, bar);
+  vgatile_setSprite(2, 100, -2, 3, dot);
+  vgatile_waitFrame();
+  tile_grab();
+  int lit = 0;
+  for(int i = 0; i < VGA_TILE_ROWS * VGA_TILE_HEIGHT; i++)
+    for(int j = 0; j < VGA_TILE_COLS; j++) lit += vidPixels[i][j] != 0;
+  check("vgatile sprites over tiles", lit == 3 * 2 + 10 + 2 &&
+        vidPixels[37][1] == 0x55555500 && vidPixels[37][2] == 0x55 &&
+        vidPixels[39][1] == 0xFFFFFF00 && vidPixels[39][2] == 0xFF &&
+        vidPixels[470][0] == 0xFFFF && vidPixels[479][0] == 0xFFFF &&
+        vidPixels[0][6] == 0xFFFFFF00 && vidPixels[0][7] == 0xFF);
+  check("vgatile keeps up with the video generator", vidLate == 0);
+
+  // Drawing after vgatile_swap goes to the other tile map, which shows
+  // after the next swap; text colors pick the colorsets
+  dprint(tiles, "Hi");
+  vgatile_swap(1);
+  vgatile_setTile(0, 0, VGA_TILE_CHAR(3, 'X'));
+  tile_grab();
+  unsigned int shown = vidColors[0];
+  vgatile_swap(0);
+  tile_grab();
+  check("vgatile swaps tile maps between frames",
+        gVgaTileScreen[1][1] == VGA_TILE_CHAR(0, 'i') &&
+        vgatile_getTile(0, 0) == VGA_TILE_CHAR(0, 'H') &&
+        (shown & 0xFC00) == 0b111111 << 10 &&
+        (vidColors[0] & 0xFC00) == 0b010101 << 10 &&
+        (vidColors[1] & 0xFC000000) == 0b111111u << 26);
+  sim_video_watch(NULL);
+  vgatile_close(tiles);
+
+  print("%d failed\n", fails);
+  return fails != 0;
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,483 @@
+/*
+ * @file pasm.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Cycle-approximate P8X32A cog emulator for libhostsim.  cognew and
+ * coginit run a PASM image here when no C stand-in is registered for it
+ * with sim_driver.
+ *
+ * @detail The image's first 496 longs are copied into cog RAM, and the
+ * cog runs them with the P8X32A instruction set, flags and conditions.
+ * Instructions take 4 clock ticks (8 for a DJNZ, TJZ or TJNZ that does
+ * not jump), hub instructions wait for the cog's hub slot and then take 8
+ * more, and WAITCNT/WAITPEQ/WAITPNE wait in simulated time and finish 2
+ * ticks after the match (6 ticks at least).  WAITVID
+ * waits one video frame, timed from VSCL and the counter A PLL, but the
+ * video generator does not drive pins; sim_video_watch sees its frames.
+ *
+ * Time spent on instructions that only touch cog RAM is added up and
+ * handed to the simulator before the next pin, counter or hub access, so
+ * the cog runs at full host speed between them.
+ *
+ * Hub addresses in the host program's data or heap are used as they
+ * are, so pointers C code passes in PAR or in hub structures work.  Any
+ * other address wraps at 64 KB like the Propeller's, so drivers that leave
+ * junk in the upper bits (VGA tile lookups) still work.  Below $10000,
+ * longs 0 and 1 hold CLKFREQ and CLKMODE, $8000-$FFFF are the ROM's log,
+ * antilog and sine tables (the font reads as 0), and any other address is
+ * taken as a host address a driver has cut down to 16 bits, and goes to
+ * the one closest to PAR with those low bits.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <string.h>
+#include <math.h>
+#include "hostsim.h"
+
+sim_time_t sim_spend(int ticks);
+void sim_cog_cost(int ticks);
+
+enum {PAR = 0x1F0, CNT_ = 0x1F1, INA_ = 0x1F2, INB_ = 0x1F3, OUTA_ = 0x1F4,
+      DIRA_ = 0x1F6, CTRA_ = 0x1F8, FRQA_ = 0x1FA, PHSA_ = 0x1FC,
+      PHSB_ = 0x1FD, VCFG_ = 0x1FE, VSCL_ = 0x1FF};
+
+static const int simReg[16] = {-1, -1, -1, -1, SIM_OUTA, SIM_OUTB,
+  SIM_DIRA, SIM_DIRB, SIM_CTRA, SIM_CTRB, SIM_FRQA, SIM_FRQB, SIM_PHSA,
+  SIM_PHSB, SIM_VCFG, SIM_VSCL};
+
+typedef struct
+{
+  unsigned int mem[512];
+  unsigned int pc, par;
+  int c, z, id;
+  sim_time_t now;                             // Simulator's time for us
+  unsigned int due;                           // Ticks not handed over yet
+  sim_time_t vidNext;                         // Video generator free
+} pasm_t;
+
+static sim_video_t videoWatch;
+
+void sim_video_watch(sim_video_t fn)
+{
+  videoWatch = fn;
+}
+
+
+
+/* Hub memory */
+
+static unsigned int lowHub[2];
+static uint16_t rom[0x4000];                  // $8000-$FFFF as words
+
+static void rom_init(void)
+{
+  static int done;
+  if(done++) return;
+  for(int i = 0; i < 2048; i++)               // $C000 log, $D000 antilog
+  {
+    rom[0x2000 + i] = (uint16_t) lround(log2(1 + i / 2048.0) * 65536);
+    rom[0x2800 + i] = (uint16_t) lround((exp2(i / 2048.0) - 1) * 65536);
+  }
+  for(int i = 0; i <= 2048; i++)              // $E000 sine, first quadrant
+    rom[0x3000 + i] = (uint16_t) lround(sin(i * M_PI / 4096) * 65535);
+}
+
+extern char etext[], end[];                   // Host data
+extern void *sbrk(intptr_t);
+static uintptr_t heapStart;
+
+#ifndef __GLIBC__
+__attribute__((constructor(101))) static void heap_start(void)
+{
+  heapStart = (uintptr_t) sbrk(0);            // Before other constructors
+}                                             // can malloc
+#endif
+
+static void *hub(pasm_t *p, unsigned int addr)
+{
+#ifdef __GLIBC__
+  if(!heapStart)                              // malloc's heap grows up from
+  {                                           // here, past a random gap
+    heapStart = (uintptr_t) sbrk(0) - mallinfo2().arena;
+  }
+#endif
+  if((addr >= (uintptr_t) etext && addr < (uintptr_t) end) ||
+     (addr >= heapStart && addr < (uintptr_t) sbrk(0)))
+    return (void *) (uintptr_t) addr;
+  addr &= 0xFFFF;                             // Hub addresses wrap at 64 KB
+  if(addr < 8)
+  {
+    lowHub[0] = _clkfreq;
+    lowHub[1] = _clkmode;
+    return (char *) lowHub + addr;
+  }
+  if(addr >= 0x8000) return (char *) rom + (addr - 0x8000);
+  unsigned int host = (p->par & ~0xFFFFu) | addr;
+  if(host > p->par + 0x8000 && host >= 0x10000) host -= 0x10000;
+  else if(host + 0x8000 < p->par) host += 0x10000;
+  return (void *) (uintptr_t) host;
+}
+
+
+
+/* Simulator hand-offs */
+
+static void sync(pasm_t *p)
+{
+  p->now = sim_spend(p->due);
+  p->due = 0;
+}
+
+static void hub_slot(pasm_t *p)               // Wait for our turn at the hub
+{
+  sync(p);
+  p->due = ((unsigned int) p->id * 2 - (unsigned int) p->now) & 15;
+  sync(p);
+}
+
+static unsigned int reg_get(pasm_t *p, int r)
+{
+  switch(r)
+  {
+    case PAR: return p->par;
+    case CNT_: return (unsigned int) (p->now + p->due);
+    case INA_: sync(p); return sim_pins();
+    case INB_: return 0;
+    case PHSA_:
+    case PHSB_: sync(p); return *sim_reg(simReg[r - PAR]);
+  }
+  return p->mem[r];
+}
+
+static void reg_put(pasm_t *p, int r, unsigned int value)
+{
+  p->mem[r] = value;
+  if(r < OUTA_) return;                       // PAR, CNT, INA, INB shadows
+  sync(p);
+  *sim_reg(simReg[r - PAR]) = value;
+  sync(p);                                    // Drive the pins now
+}
+
+static unsigned int vid_ticks(pasm_t *p)      // One WAITVID frame
+{
+  unsigned int frame = p->mem[VSCL_] & 0xFFF;
+  unsigned int ctr = p->mem[CTRA_], frq = p->mem[FRQA_];
+  if(!frame) frame = 4096;
+  if(((ctr >> 26) & 31) != 1 || !frq) return frame;
+  unsigned long long div = 1ULL << (7 - ((ctr >> 23) & 7));
+  return (unsigned int) (((unsigned long long) frame << 28) * div / frq);
+}
+
+
+
+/* Instructions */
+
+static sim_time_t wait_start(pasm_t *p)       // WAITxxx compares from its
+{                                             // second cycle
+  sync(p);
+  sim_time_t start = p->now;
+  p->due = 1;
+  sync(p);
+  return start;
+}
+
+static int wait_end(pasm_t *p, sim_time_t start)  // Done 2 cycles after
+{                                                 // the match, 6 at least
+  sync(p);
+  int waited = (int) (p->now - start);
+  return waited < 4 ? 6 - waited : 2;
+}
+
+static int parity(unsigned int v)
+{
+  return __builtin_parity(v);
+}
+
+static unsigned int hubop(pasm_t *p, unsigned int d, int op, int *c)
+{
+  void *code;
+  int id;
+  switch(op & 7)
+  {
+    case 0: clkset(d & 0xFF, _clkfreq); return d;
+    case 1: return p->id;
+    case 2:
+      code = hub(p, ((d >> 4) & 0x3FFF) << 2);
+      id = coginit(d & 15, code, hub(p, ((d >> 18) & 0x3FFF) << 2));
+      *c = id < 0;
+      return id < 0 ? 7 : id;
+    case 3: cogstop(d & 7); return d;
+    case 4: id = locknew(); *c = id < 0; return id < 0 ? 7 : id;
+    case 5: lockret(d & 7); return d;
+    case 6: *c = lockset(d & 7) != 0; return d;
+    default: *c = lockclr(d & 7) != 0; return d;
+  }
+}
+
+static void run(pasm_t *p)
+{
+  for(;;)
+  {
+    unsigned int in = p->mem[p->pc];
+    int op = in >> 26, wz = (in >> 25) & 1, wc = (in >> 24) & 1;
+    int wr = (in >> 23) & 1, imm = (in >> 22) & 1;
+    int cond = (in >> 18) & 15;
+    int dst = (in >> 9) & 511, src = in & 511;
+    unsigned int next = (p->pc + 1) & 511;
+
+    if(p->due > 1024) sync(p);                // Let the others have a turn
+    if(!((cond >> (p->c * 2 + p->z)) & 1))
+    {
+      p->pc = next;
+      p->due += 4;
+      continue;
+    }
+
+    unsigned int s = imm ? (unsigned int) src :
+                     src >= PAR ? reg_get(p, src) : p->mem[src];
+    unsigned int d = p->mem[dst];             // Shadow registers as dest
+    unsigned int r = d;
+    int c = p->c, z = -1, cycles = 4;
+    unsigned long long wide;
+    long long sw;
+    unsigned int n = s & 31;
+    sim_time_t start;
+    void *a;
+
+    switch(op)
+    {
+      case 0x00: case 0x01: case 0x02:        // WR/RD BYTE/WORD/LONG
+        a = hub(p, s & ~((1u << op) - 1));
+        hub_slot(p);
+        if(wr)
+        {
+          r = op == 0 ? *(volatile uint8_t *) a : op == 1 ?
+              *(volatile uint16_t *) a : *(volatile uint32_t *) a;
+        }
+        else if(op == 0) *(volatile uint8_t *) a = d;
+        else if(op == 1) *(volatile uint16_t *) a = d;
+        else *(volatile uint32_t *) a = d;
+        cycles = 8;
+        break;
+      case 0x03:                              // Hub operations
+        hub_slot(p);
+        r = hubop(p, d, s, &c);
+        cycles = 8;
+        break;
+      case 0x08: r = n ? (d >> n) | (d << (32 - n)) : d; c = d & 1; break;
+      case 0x09: r = n ? (d << n) | (d >> (32 - n)) : d; c = d >> 31; break;
+      case 0x0A: r = d >> n; c = d & 1; break;
+      case 0x0B: r = d << n; c = d >> 31; break;
+      case 0x0C:                              // RCR
+        r = d >> n;
+        if(p->c && n) r |= ~(0xFFFFFFFFu >> n);
+        c = d & 1;
+        break;
+      case 0x0D:                              // RCL
+        r = d << n;
+        if(p->c && n) r |= (1u << n) - 1;
+        c = d >> 31;
+        break;
+      case 0x0E: r = (unsigned int) ((int) d >> n); c = d & 1; break;
+      case 0x0F:                              // REV
+        r = 0;
+        for(int i = 0; i < 32; i++) r |= ((d >> i) & 1) << (31 - i);
+        r >>= n;
+        c = d & 1;
+        break;
+      case 0x10: c = (int) d < (int) s; r = c ? s : d; z = s == 0; break;
+      case 0x11: c = (int) d < (int) s; r = c ? d : s; z = s == 0; break;
+      case 0x12: c = d < s; r = c ? s : d; z = s == 0; break;
+      case 0x13: c = d < s; r = c ? d : s; z = s == 0; break;
+      case 0x14: r = (d & ~0x1FFu) | (s & 0x1FF); break;
+      case 0x15: r = (d & ~(0x1FFu << 9)) | ((s & 0x1FF) << 9); break;
+      case 0x16: r = (d & ~(0x1FFu << 23)) | ((s & 0x1FF) << 23); break;
+      case 0x17:                              // JMPRET, JMP, CALL, RET
+        r = (d & ~0x1FFu) | next;
+        next = s & 0x1FF;
+        break;
+      case 0x18: r = d & s; c = parity(r); break;
+      case 0x19: r = d & ~s; c = parity(r); break;
+      case 0x1A: r = d | s; c = parity(r); break;
+      case 0x1B: r = d ^ s; c = parity(r); break;
+      case 0x1C: r = (d & ~s) | (p->c ? s : 0); c = parity(r); break;
+      case 0x1D: r = (d & ~s) | (p->c ? 0 : s); c = parity(r); break;
+      case 0x1E: r = (d & ~s) | (p->z ? s : 0); c = parity(r); break;
+      case 0x1F: r = (d & ~s) | (p->z ? 0 : s); c = parity(r); break;
+      case 0x20: wide = (unsigned long long) d + s; r = wide; c = wide >> 32;
+        break;
+      case 0x21: r = d - s; c = d < s; break;
+      case 0x22:                              // ADDABS
+        if((int) s < 0)
+        {
+          r = d + (unsigned int) -(int) s;
+          c = d < (unsigned int) -(int) s;
+        }
+        else
+        {
+          wide = (unsigned long long) d + s;
+          r = wide;
+          c = wide >> 32;
+        }
+        break;
+      case 0x23:                              // SUBABS
+        if((int) s < 0)
+        {
+          wide = (unsigned long long) d + (unsigned int) -(int) s;
+          r = wide;
+          c = wide >> 32;
+        }
+        else
+        {
+          r = d - s;
+          c = d < s;
+        }
+        break;
+      case 0x24: case 0x25: case 0x26: case 0x27:     // SUMC ... SUMNZ
+      {
+        int flag = op < 0x26 ? p->c : p->z;
+        int sub = (op & 1) ? !flag : flag;
+        sw = sub ? (long long) (int) d - (int) s : (long long) (int) d + (int) s;
+        r = (unsigned int) sw;
+        c = sw != (int) r;
+        break;
+      }
+      case 0x28: r = s; c = s >> 31; break;
+      case 0x29: r = -s; c = s >> 31; break;
+      case 0x2A: r = (int) s < 0 ? -s : s; c = s >> 31; break;
+      case 0x2B: r = (int) s < 0 ? s : -s; c = s >> 31; break;
+      case 0x2C: r = p->c ? -s : s; c = s >> 31; break;
+      case 0x2D: r = p->c ? s : -s; c = s >> 31; break;
+      case 0x2E: r = p->z ? -s : s; c = s >> 31; break;
+      case 0x2F: r = p->z ? s : -s; c = s >> 31; break;
+      case 0x30: r = d - s; c = (int) d < (int) s; break;     // CMPS
+      case 0x31: case 0x37:                   // CMPSX, SUBSX
+        sw = (long long) (int) d - (int) s - p->c;
+        r = (unsigned int) sw;
+        c = op == 0x31 ? sw < 0 : sw != (int) r;
+        z = p->z && r == 0;
+        break;
+      case 0x32: case 0x36:                   // ADDX, ADDSX
+        wide = (unsigned long long) d + s + p->c;
+        r = wide;
+        sw = (long long) (int) d + (int) s + p->c;
+        c = op == 0x32 ? (int) (wide >> 32) : sw != (int) r;
+        z = p->z && r == 0;
+        break;
+      case 0x33:                              // SUBX, CMPX
+        r = d - s - p->c;
+        c = (unsigned long long) d < (unsigned long long) s + p->c;
+        z = p->z && r == 0;
+        break;
+      case 0x34: case 0x35:                   // ADDS, SUBS
+        sw = op == 0x34 ? (long long) (int) d + (int) s :
+                          (long long) (int) d - (int) s;
+        r = (unsigned int) sw;
+        c = sw != (int) r;
+        break;
+      case 0x38:                              // CMPSUB
+        c = d >= s;
+        z = d == s;                           // Even when nothing is taken
+        r = c ? d - s : d;
+        if(!c) wr = 0;
+        break;
+      case 0x39:                              // DJNZ
+        r = d - 1;
+        c = d == 0;
+        if(r) next = s & 0x1FF;
+        else cycles = 8;
+        break;
+      case 0x3A: case 0x3B:                   // TJNZ, TJZ
+        c = 0;
+        z = d == 0;
+        if((d != 0) == (op == 0x3A)) next = s & 0x1FF;
+        else cycles = 8;
+        break;
+      case 0x3C: case 0x3D:                   // WAITPEQ, WAITPNE
+        start = wait_start(p);
+        if(op == 0x3C) sim_waitpeq(d, s);
+        else sim_waitpne(d, s);
+        cycles = wait_end(p, start);
+        break;
+      case 0x3E:                              // WAITCNT
+        start = wait_start(p);
+        sim_waitcnt(d);
+        cycles = wait_end(p, start);
+        wide = (unsigned long long) d + s;
+        r = wide;
+        c = wide >> 32;
+        break;
+      case 0x3F:                              // WAITVID
+        sync(p);
+        if(videoWatch)                        // Late if the generator ran dry
+          videoWatch(p->id, p->mem[VSCL_], d, s, p->vidNext < p->now);
+        if(p->vidNext > p->now)
+        {
+          p->due = p->vidNext - p->now;
+          sync(p);
+        }
+        p->vidNext = p->now + vid_ticks(p);
+        p->due = 3;
+        cycles = 4;
+        break;
+      default:                                // No instruction
+        wr = 0;
+        break;
+    }
+
+    if(z < 0) z = r == 0;
+    p->due += cycles;
+    if(wz) p->z = z;
+    if(wc) p->c = c;
+    if(wr)
+    {
+      if(dst >= PAR) reg_put(p, dst, r);
+      else p->mem[dst] = r;
+    }
+    p->pc = next;
+  }
+}
+
+void sim_pasm_cog(void *start)
+{
+  void **s = start;
+  pasm_t *p = calloc(1, sizeof(pasm_t));
+  rom_init();
+  p->par = (unsigned int) (uintptr_t) s[1] & ~3u;
+  memcpy(p->mem, s[0], 496 * sizeof(int));
+  free(start);
+  p->id = cogid();
+  sim_cog_cost(0);
+  p->now = sim_spend(0);
+  run(p);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,140 @@
+/*
+ * @file pst.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief C stand-in for the fdserial library's PASM driver (pst.spin), so 
+ * fdserial.c and the libraries built on it (gps, abdrive's terminal, ...) 
+ * run unmodified with libhostsim.
+ *
+ * @detail Like the PASM driver, it polls several times per bit, moving
+ * received bytes into the rx buffer and sending bytes from the tx buffer
+ * through the same fdserial_st structure.
+ */
+
+#include "hostsim.h"
+#include "fdserial.h"
+
+extern unsigned int binary_pst_dat_start[];
+
+void sim_rx_listen(int pin, int on);
+void sim_term_feed(void);
+
+static void pst_tx(unsigned int mask, int level, int mode)
+{
+  if(mode & FDSERIAL_MODE_INVERT_TX) level = !level;
+  if(mode & FDSERIAL_MODE_OPENDRAIN_TX)
+  {
+    OUTA &= ~mask;
+    if(level) DIRA &= ~mask;
+    else DIRA |= mask;
+  }
+  else
+  {
+    if(level) OUTA |= mask;
+    else OUTA &= ~mask;
+    DIRA |= mask;
+  }
+}
+
+static void pst_cog(void *par)
+{
+  volatile fdserial_st *p = par;
+  int ticks = p->ticks;
+  int q = ticks / 4 ? ticks / 4 : 1;
+  int mode = p->mode;
+  unsigned int rxmask = 1 << p->rx_pin, txmask = 1 << p->tx_pin;
+  volatile char *rxbuf = p->buffptr;
+  volatile char *txbuf = p->buffptr + FDSERIAL_BUFF_MASK + 1;
+  int rxbit = -1, rxbyte = 0, txbit = -1, txword = 0;
+  unsigned int rxt = 0, txt = 0;
+
+  pst_tx(txmask, 1, mode);
+  if(p->rx_pin == 31) sim_rx_listen(31, 1);   // Terminal types into buffer
+  unsigned int t = CNT;
+  for(;;)
+  {
+    waitcnt(t += q);
+
+    int in = (INA & rxmask) != 0;
+    if(mode & FDSERIAL_MODE_INVERT_RX) in = !in;
+    if(rxbit < 0)
+    {
+      if(!in)                                 // Start bit
+      {
+        rxbit = rxbyte = 0;
+        rxt = t + ticks + ticks / 2 - q / 2;
+      }
+      else if(p->rx_pin == 31 && ((p->rx_head + 1) & FDSERIAL_BUFF_MASK)
+              != p->rx_tail) sim_term_feed();
+    }
+    else if((int) (t - rxt) >= 0)
+    {
+      if(rxbit < 8)
+      {
+        rxbyte |= in << rxbit++;
+        rxt += ticks;
+      }
+      else                                    // Middle of stop bit
+      {
+        int head = p->rx_head;
+        if(((head + 1) & FDSERIAL_BUFF_MASK) != p->rx_tail)
+        {
+          rxbuf[head] = rxbyte;
+          p->rx_head = (head + 1) & FDSERIAL_BUFF_MASK;
+        }
+        rxbit = -1;
+      }
+    }
+
+    if(txbit < 0 && p->tx_tail != p->tx_head)
+    {
+      int tail = p->tx_tail;
+      txword = ((txbuf[tail] & 0xFF) | 0x100) << 1;
+      p->tx_tail = (tail + 1) & FDSERIAL_BUFF_MASK;
+      txbit = 0;
+      txt = t;
+    }
+    if(txbit >= 0 && (int) (t - txt) >= 0)
+    {
+      if(txbit < 10)
+      {
+        pst_tx(txmask, txword & 1, mode);
+        txword >>= 1;
+        txbit++;
+        txt += ticks;
+      }
+      else txbit = -1;                        // End of stop bit
+    }
+  }
+}
+
+void sim_pst_init(void)
+{
+  sim_driver(binary_pst_dat_start, pst_cog);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
\ No newline at end of file
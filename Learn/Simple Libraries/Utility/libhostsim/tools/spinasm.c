@@ -0,0 +1,792 @@
+/*
+ * @file spinasm.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Host computer program that assembles the DAT section of a Spin
+ * file into the PASM image PropGCC links in as binary_<name>_dat_start,
+ * so libhostsim can run the library's own driver on its cog emulator.
+ *
+ * @details Build with any C compiler for the computer (not the Propeller):
+ *
+ *   cc -O2 -o spinasm spinasm.c
+ *
+ * Usage:
+ *
+ *   spinasm [-l] [-n name] file.spin out.c|out.dat
+ *
+ *   -l  Print a listing (cog address, long, source line).
+ *   -n  Symbol name (default: the Spin file's name), giving
+ *       binary_name_dat_start in a .c output file.
+ *
+ * A .c output file holds the image as an array of longs, padded to the
+ * 496 longs a cog loads, and binary_name_dat_end at the end of the image
+ * itself, as objcopy makes for PropGCC.  Any other output file gets the raw
+ * bytes.
+ *
+ * Handles CON constants and enumerations, DAT labels (including :local
+ * ones), org, res, fit, byte/word/long data and the P8X32A instruction
+ * set with conditions and effects.  Spin methods are skipped.  Spin files
+ * may be UTF-8 or UTF-16.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_SYMS 2048
+#define MAX_LINES 8192
+#define MAX_IMAGE 8192                        // Longs
+#define MAX_TOKENS 128
+
+typedef struct { char name[64]; long value; } sym_t;
+typedef struct { int line; char *text; } line_t;
+typedef struct { int type; long value; char text[64]; } tok_t;
+
+enum {T_END, T_NUM, T_ID, T_STR, T_OP};
+
+static sym_t syms[MAX_SYMS];
+static int nsyms;
+static line_t lines[MAX_LINES];
+static int nlines;
+static unsigned char image[MAX_IMAGE * 4];
+static const char *file;
+static int curLine, pass, unresolved, listing;
+static long cogHere;
+
+
+
+/* Errors and symbols */
+
+static void fail(const char *msg, const char *what)
+{
+  fprintf(stderr, "%s:%d: %s%s%s\n", file, curLine, msg, what ? ": " : "",
+          what ? what : "");
+  exit(1);
+}
+
+static sym_t *sym_find(const char *name)
+{
+  for(int i = 0; i < nsyms; i++)
+    if(!strcmp(syms[i].name, name)) return &syms[i];
+  return NULL;
+}
+
+static void sym_set(const char *name, long value)
+{
+  sym_t *s = sym_find(name);
+  if(s)
+  {
+    if(pass == 1 && s->value != value)
+      fail("symbol defined twice", name);
+    s->value = value;
+    return;
+  }
+  if(nsyms == MAX_SYMS) fail("too many symbols", NULL);
+  snprintf(syms[nsyms].name, sizeof(syms[nsyms].name), "%s", name);
+  syms[nsyms++].value = value;
+}
+
+static const struct { const char *name; int reg; } regs[] = {
+  {"par", 0x1F0}, {"cnt", 0x1F1}, {"ina", 0x1F2}, {"inb", 0x1F3},
+  {"outa", 0x1F4}, {"outb", 0x1F5}, {"dira", 0x1F6}, {"dirb", 0x1F7},
+  {"ctra", 0x1F8}, {"ctrb", 0x1F9}, {"frqa", 0x1FA}, {"frqb", 0x1FB},
+  {"phsa", 0x1FC}, {"phsb", 0x1FD}, {"vcfg", 0x1FE}, {"vscl", 0x1FF},
+  {"true", -1}, {"false", 0}, {"posx", 0x7FFFFFFF}, {"negx", -0x7FFFFFFF - 1},
+  {NULL, 0}};
+
+
+
+/* Source text */
+
+static char *read_source(const char *name)
+{
+  FILE *f = fopen(name, "rb");
+  if(!f) fail("cannot open", name);
+  fseek(f, 0, SEEK_END);
+  long n = ftell(f);
+  rewind(f);
+  unsigned char *raw = malloc(n + 2);
+  if(fread(raw, 1, n, f) != (size_t) n) fail("cannot read", name);
+  fclose(f);
+  char *text = malloc(n + 1);
+  long len = 0;
+  if(n >= 2 && raw[0] == 0xFF && raw[1] == 0xFE)         // UTF-16LE
+  {
+    for(long i = 2; i + 1 < n; i += 2)
+    {
+      int ch = raw[i] | (raw[i + 1] << 8);
+      text[len++] = ch < 128 ? ch : ' ';
+    }
+  }
+  else
+  {
+    for(long i = 0; i < n; i++) text[len++] = raw[i] < 128 ? raw[i] : ' ';
+  }
+  text[len] = 0;
+  free(raw);
+
+  char *out = malloc(len + 1);                // Strip comments
+  long o = 0;
+  int depth = 0, doc = 0, str = 0;
+  for(long i = 0; i < len; i++)
+  {
+    char ch = text[i];
+    if(doc)
+    {
+      if(ch == '}' && text[i + 1] == '}') { doc = 0; i++; }
+      else if(ch == '\n') out[o++] = ch;
+      continue;
+    }
+    if(depth)
+    {
+      if(ch == '{') depth++;
+      else if(ch == '}') depth--;
+      else if(ch == '\n') out[o++] = ch;
+      continue;
+    }
+    if(str)
+    {
+      if(ch == '"' || ch == '\n') str = 0;
+      out[o++] = ch;
+      continue;
+    }
+    if(ch == '"') str = 1;
+    else if(ch == '{' && text[i + 1] == '{') { doc = 1; i++; continue; }
+    else if(ch == '{') { depth = 1; continue; }
+    else if(ch == '\'')
+    {
+      while(i < len && text[i] != '\n') i++;
+      i--;
+      continue;
+    }
+    if(ch != '\r') out[o++] = ch;
+  }
+  out[o] = 0;
+  free(text);
+  return out;
+}
+
+
+
+/* Tokens and expressions */
+
+static tok_t tok[MAX_TOKENS];
+static int ntok, at;
+
+static const char *ops[] = {"<<", ">>", "~>", "->", "<-", "><", "//", "**",
+  "+", "-", "*", "/", "&", "|", "^", "!", "~", "=", "(", ")", "[", "]",
+  ",", "#", "@", NULL};
+
+static void tokenize(const char *s)
+{
+  ntok = at = 0;
+  while(*s)
+  {
+    tok_t *t = &tok[ntok];
+    if(ntok == MAX_TOKENS - 1) fail("line too long", NULL);
+    if(isspace((unsigned char) *s)) { s++; continue; }
+    t->text[0] = 0;
+    if(isdigit((unsigned char) *s) || (*s == '$' && isxdigit((unsigned char) s[1]))
+       || (*s == '%' && (s[1] == '0' || s[1] == '1' || s[1] == '%')))
+    {
+      int base = 10;
+      if(*s == '$') { base = 16; s++; }
+      else if(*s == '%' && s[1] == '%') { base = 4; s += 2; }
+      else if(*s == '%') { base = 2; s++; }
+      long v = 0;
+      for(;; s++)
+      {
+        int dg;
+        if(*s == '_') continue;
+        if(isdigit((unsigned char) *s)) dg = *s - '0';
+        else if(isxdigit((unsigned char) *s)) dg = tolower(*s) - 'a' + 10;
+        else break;
+        if(dg >= base) break;
+        v = v * base + dg;
+      }
+      if(*s == '.') fail("floating point constants are not supported", NULL);
+      t->type = T_NUM;
+      t->value = (unsigned int) v;
+    }
+    else if(isalpha((unsigned char) *s) || *s == '_' ||
+            (*s == ':' && (isalpha((unsigned char) s[1]) || s[1] == '_')))
+    {
+      int n = 0;
+      t->text[n++] = *s++;
+      while((isalnum((unsigned char) *s) || *s == '_') && n < 62)
+        t->text[n++] = tolower(*s++);
+      t->text[n] = 0;
+      t->text[0] = tolower(t->text[0]);
+      t->type = T_ID;
+    }
+    else if(*s == '"')
+    {
+      int n = 0;
+      for(s++; *s && *s != '"' && n < 62; s++) t->text[n++] = *s;
+      t->text[n] = 0;
+      if(*s == '"') s++;
+      t->type = T_STR;
+    }
+    else if(*s == '$')
+    {
+      strcpy(t->text, "$");
+      t->type = T_ID;
+      s++;
+    }
+    else
+    {
+      int k;
+      for(k = 0; ops[k] && strncmp(s, ops[k], strlen(ops[k])); k++);
+      if(!ops[k])
+      {
+        char bad[2] = {*s, 0};
+        fail("unexpected character", bad);
+      }
+      strcpy(t->text, ops[k]);
+      s += strlen(ops[k]);
+      t->type = T_OP;
+    }
+    ntok++;
+  }
+  tok[ntok].type = T_END;
+  tok[ntok].text[0] = 0;
+}
+
+static int is_op(const char *op)
+{
+  return tok[at].type == T_OP && !strcmp(tok[at].text, op);
+}
+
+static char scope[64];
+
+static long expr(void);
+
+static long atom(void)
+{
+  tok_t *t = &tok[at];
+  if(is_op("("))
+  {
+    at++;
+    long v = expr();
+    if(!is_op(")")) fail("missing )", NULL);
+    at++;
+    return v;
+  }
+  if(is_op("-")) { at++; return -atom(); }
+  if(is_op("!")) { at++; return ~atom(); }
+  if(is_op("@")) { at++; return atom(); }
+  if(t->type == T_NUM) { at++; return t->value; }
+  if(t->type == T_STR && strlen(t->text) == 1) { at++; return t->text[0]; }
+  if(t->type != T_ID) fail("expected a value", t->text);
+  at++;
+  if(!strcmp(t->text, "$")) return cogHere;
+  char name[140];
+  if(t->text[0] == ':') snprintf(name, sizeof(name), "%s%s", scope, t->text);
+  else snprintf(name, sizeof(name), "%s", t->text);
+  sym_t *s = sym_find(name);
+  if(s) return s->value;
+  for(int i = 0; regs[i].name; i++)
+    if(!strcmp(regs[i].name, name)) return regs[i].reg;
+  if(pass == 2) fail("undefined symbol", name);
+  unresolved = 1;
+  return 0;
+}
+
+static long shifts(void)
+{
+  long v = atom();
+  for(;;)
+  {
+    unsigned int u = v, n;
+    if(is_op("<<")) { at++; v = (unsigned int) (u << (atom() & 31)); }
+    else if(is_op(">>")) { at++; v = u >> (atom() & 31); }
+    else if(is_op("~>")) { at++; v = (int) u >> (atom() & 31); }
+    else if(is_op("->")) { at++; n = atom() & 31; v = n ? (u >> n) | (u << (32 - n)) : u; }
+    else if(is_op("<-")) { at++; n = atom() & 31; v = n ? (u << n) | (u >> (32 - n)) : u; }
+    else if(is_op("><"))
+    {
+      at++;
+      n = atom() & 31;
+      unsigned int r = 0;
+      for(unsigned int i = 0; i < n; i++) r |= ((u >> i) & 1) << (n - 1 - i);
+      v = r;
+    }
+    else return v;
+  }
+}
+
+static long ands(void)
+{
+  long v = shifts();
+  while(is_op("&")) { at++; v &= shifts(); }
+  return v;
+}
+
+static long ors(void)
+{
+  long v = ands();
+  for(;;)
+  {
+    if(is_op("|")) { at++; v |= ands(); }
+    else if(is_op("^")) { at++; v ^= ands(); }
+    else return v;
+  }
+}
+
+static long products(void)
+{
+  long v = ors();
+  for(;;)
+  {
+    long w;
+    if(is_op("*")) { at++; v = (int) v * (int) ors(); }
+    else if(is_op("/") || is_op("//"))
+    {
+      int mod = is_op("//");
+      at++;
+      w = ors();
+      if(!w) { if(pass == 2) fail("divide by zero", NULL); w = 1; }
+      v = mod ? (int) v % (int) w : (int) v / (int) w;
+    }
+    else return v;
+  }
+}
+
+static long expr(void)
+{
+  long v = products();
+  for(;;)
+  {
+    if(is_op("+")) { at++; v = (unsigned int) (v + products()); }
+    else if(is_op("-")) { at++; v = (unsigned int) (v - products()); }
+    else return (int) v;
+  }
+}
+
+
+
+/* Instructions */
+
+static const struct { const char *name; int bits; } conds[] = {
+  {"if_always", 15}, {"if_never", 0}, {"if_e", 10}, {"if_ne", 5},
+  {"if_a", 1}, {"if_b", 12}, {"if_ae", 3}, {"if_be", 14},
+  {"if_c", 12}, {"if_nc", 3}, {"if_z", 10}, {"if_nz", 5},
+  {"if_c_eq_z", 9}, {"if_c_ne_z", 6}, {"if_c_and_z", 8}, {"if_c_and_nz", 4},
+  {"if_nc_and_z", 2}, {"if_nc_and_nz", 1}, {"if_c_or_z", 14},
+  {"if_c_or_nz", 13}, {"if_nc_or_z", 11}, {"if_nc_or_nz", 7},
+  {"if_z_eq_c", 9}, {"if_z_ne_c", 6}, {"if_z_and_c", 8}, {"if_z_and_nc", 2},
+  {"if_nz_and_c", 4}, {"if_nz_and_nc", 1}, {"if_z_or_c", 14},
+  {"if_z_or_nc", 11}, {"if_nz_or_c", 13}, {"if_nz_or_nc", 7}, {NULL, 0}};
+
+enum {F_DS, F_S, F_D, F_CALL, F_RET, F_NOP};
+
+static const struct { const char *name; int op, r, form, s; } instrs[] = {
+  {"wrbyte", 0, 0, F_DS}, {"rdbyte", 0, 1, F_DS}, {"wrword", 1, 0, F_DS},
+  {"rdword", 1, 1, F_DS}, {"wrlong", 2, 0, F_DS}, {"rdlong", 2, 1, F_DS},
+  {"clkset", 3, 0, F_D, 0}, {"cogid", 3, 1, F_D, 1}, {"coginit", 3, 0, F_D, 2},
+  {"cogstop", 3, 0, F_D, 3}, {"locknew", 3, 1, F_D, 4},
+  {"lockret", 3, 0, F_D, 5}, {"lockset", 3, 0, F_D, 6},
+  {"lockclr", 3, 0, F_D, 7},
+  {"ror", 8, 1, F_DS}, {"rol", 9, 1, F_DS}, {"shr", 10, 1, F_DS},
+  {"shl", 11, 1, F_DS}, {"rcr", 12, 1, F_DS}, {"rcl", 13, 1, F_DS},
+  {"sar", 14, 1, F_DS}, {"rev", 15, 1, F_DS}, {"mins", 16, 1, F_DS},
+  {"maxs", 17, 1, F_DS}, {"min", 18, 1, F_DS}, {"max", 19, 1, F_DS},
+  {"movs", 20, 1, F_DS}, {"movd", 21, 1, F_DS}, {"movi", 22, 1, F_DS},
+  {"jmpret", 23, 1, F_DS}, {"jmp", 23, 0, F_S}, {"call", 23, 1, F_CALL},
+  {"ret", 23, 0, F_RET}, {"test", 24, 0, F_DS}, {"testn", 25, 0, F_DS},
+  {"and", 24, 1, F_DS}, {"andn", 25, 1, F_DS}, {"or", 26, 1, F_DS},
+  {"xor", 27, 1, F_DS}, {"muxc", 28, 1, F_DS}, {"muxnc", 29, 1, F_DS},
+  {"muxz", 30, 1, F_DS}, {"muxnz", 31, 1, F_DS}, {"add", 32, 1, F_DS},
+  {"sub", 33, 1, F_DS}, {"cmp", 33, 0, F_DS}, {"addabs", 34, 1, F_DS},
+  {"subabs", 35, 1, F_DS}, {"sumc", 36, 1, F_DS}, {"sumnc", 37, 1, F_DS},
+  {"sumz", 38, 1, F_DS}, {"sumnz", 39, 1, F_DS}, {"mov", 40, 1, F_DS},
+  {"neg", 41, 1, F_DS}, {"abs", 42, 1, F_DS}, {"absneg", 43, 1, F_DS},
+  {"negc", 44, 1, F_DS}, {"negnc", 45, 1, F_DS}, {"negz", 46, 1, F_DS},
+  {"negnz", 47, 1, F_DS}, {"cmps", 48, 0, F_DS}, {"cmpsx", 49, 0, F_DS},
+  {"addx", 50, 1, F_DS}, {"subx", 51, 1, F_DS}, {"cmpx", 51, 0, F_DS},
+  {"adds", 52, 1, F_DS}, {"subs", 53, 1, F_DS}, {"addsx", 54, 1, F_DS},
+  {"subsx", 55, 1, F_DS}, {"cmpsub", 56, 1, F_DS}, {"djnz", 57, 1, F_DS},
+  {"tjnz", 58, 0, F_DS}, {"tjz", 59, 0, F_DS}, {"waitpeq", 60, 0, F_DS},
+  {"waitpne", 61, 0, F_DS}, {"waitcnt", 62, 1, F_DS},
+  {"waitvid", 63, 0, F_DS}, {"nop", 0, 0, F_NOP}, {NULL, 0}};
+
+static int find_cond(const char *name)
+{
+  for(int i = 0; conds[i].name; i++)
+    if(!strcmp(conds[i].name, name)) return conds[i].bits;
+  return -1;
+}
+
+static int find_instr(const char *name)
+{
+  for(int i = 0; instrs[i].name; i++)
+    if(!strcmp(instrs[i].name, name)) return i;
+  return -1;
+}
+
+static int is_keyword(const char *name)
+{
+  return find_cond(name) >= 0 || find_instr(name) >= 0 ||
+         !strcmp(name, "org") || !strcmp(name, "res") ||
+         !strcmp(name, "fit") || !strcmp(name, "long") ||
+         !strcmp(name, "word") || !strcmp(name, "byte");
+}
+
+static unsigned int field(long v, const char *what)
+{
+  if(pass == 2 && (v < 0 || v > 511)) fail("value does not fit in 9 bits", what);
+  return v & 511;
+}
+
+static unsigned int assemble(int cond)
+{
+  int k = find_instr(tok[at].text);
+  unsigned int op = instrs[k].op, zcri = instrs[k].r << 1, d = 0, s = 0;
+  at++;
+  switch(instrs[k].form)
+  {
+    case F_NOP:
+      return 0;
+    case F_RET:
+      zcri |= 1;
+      break;
+    case F_D:
+      d = field(expr(), "destination");
+      s = instrs[k].s;
+      zcri |= 1;
+      break;
+    case F_S:
+      if(is_op("#")) { at++; zcri |= 1; }
+      s = field(expr(), "source");
+      break;
+    case F_CALL:
+    {
+      if(!is_op("#")) fail("call needs #label", NULL);
+      at++;
+      if(tok[at].type != T_ID) fail("call needs #label", NULL);
+      char ret[80];
+      snprintf(ret, sizeof(ret), "%s_ret", tok[at].text);
+      sym_t *r = sym_find(ret);
+      if(!r && pass == 2) fail("no return label", ret);
+      d = r ? field(r->value, ret) : 0;
+      s = field(expr(), "source");
+      zcri |= 1;
+      break;
+    }
+    default:
+      d = field(expr(), "destination");
+      if(!is_op(",")) fail("expected ,", tok[at].text);
+      at++;
+      if(is_op("#")) { at++; zcri |= 1; }
+      s = field(expr(), "source");
+      break;
+  }
+  while(tok[at].type != T_END)                // Effects
+  {
+    if(is_op(",")) { at++; continue; }
+    const char *e = tok[at].text;
+    if(!strcmp(e, "wz")) zcri |= 8;
+    else if(!strcmp(e, "wc")) zcri |= 4;
+    else if(!strcmp(e, "wr")) zcri |= 2;
+    else if(!strcmp(e, "nr")) zcri &= ~2u;
+    else fail("unexpected", e);
+    at++;
+  }
+  return op << 26 | zcri << 22 | (unsigned int) cond << 18 | d << 9 | s;
+}
+
+
+
+/* Sections */
+
+static long hubHere, orgHub, orgCog, resCog;
+
+static void emit(long value, int size)
+{
+  if(hubHere + size > (long) sizeof(image)) fail("image too big", NULL);
+  if(pass == 2)
+    for(int i = 0; i < size; i++) image[hubHere + i] = value >> (8 * i);
+  hubHere += size;
+}
+
+static void align(int size)
+{
+  while(hubHere % size) emit(0, 1);
+}
+
+static void cog_here(void)
+{
+  cogHere = orgCog + (hubHere - orgHub) / 4 + resCog;
+}
+
+static void dat_line(line_t *l)
+{
+  tokenize(l->text);
+  curLine = l->line;
+  if(tok[0].type == T_END) return;
+  long lineCog = -1, lineHub = hubHere;
+  char label[64] = "";
+  if(tok[at].type == T_ID && !is_keyword(tok[at].text))
+  {
+    snprintf(label, sizeof(label), "%s", tok[at].text);
+    at++;
+  }
+  int cond = 15;
+  if(tok[at].type == T_ID && find_cond(tok[at].text) >= 0)
+    cond = find_cond(tok[at++].text);
+  const char *word = tok[at].type == T_ID ? tok[at].text : "";
+  int size = !strcmp(word, "long") ? 4 : !strcmp(word, "word") ? 2 :
+             !strcmp(word, "byte") ? 1 : find_instr(word) >= 0 ? 4 : 0;
+  if(size) align(size);
+  cog_here();
+  if(label[0])
+  {
+    char name[140];
+    if(label[0] == ':') snprintf(name, sizeof(name), "%s%s", scope, label);
+    else
+    {
+      snprintf(name, sizeof(name), "%s", label);
+      snprintf(scope, sizeof(scope), "%s", label);
+    }
+    sym_set(name, cogHere);
+  }
+  lineCog = cogHere;
+  lineHub = hubHere;
+  if(!word[0])
+  {
+    if(tok[at].type != T_END) fail("unexpected", tok[at].text);
+    return;
+  }
+  if(!strcmp(word, "org"))
+  {
+    at++;
+    orgCog = tok[at].type == T_END ? 0 : expr();
+    orgHub = hubHere;
+    resCog = 0;
+  }
+  else if(!strcmp(word, "res"))
+  {
+    at++;
+    long n = tok[at].type == T_END ? 1 : expr();
+    if(unresolved && pass == 1) fail("res count must be known", NULL);
+    resCog += n;
+  }
+  else if(!strcmp(word, "fit"))
+  {
+    at++;
+    long n = tok[at].type == T_END ? 0x1F0 : expr();
+    if(pass == 2 && cogHere > n) fail("code does not fit", NULL);
+  }
+  else if(size && find_instr(word) < 0)       // byte, word, long data
+  {
+    at++;
+    if(tok[at].type == T_ID && (!strcmp(tok[at].text, "long") ||
+       !strcmp(tok[at].text, "word") || !strcmp(tok[at].text, "byte"))) at++;
+    while(tok[at].type != T_END)
+    {
+      if(tok[at].type == T_STR && strlen(tok[at].text) != 1)
+      {
+        for(const char *c = tok[at].text; *c; c++) emit(*c, size);
+        at++;
+      }
+      else
+      {
+        long v = expr(), count = 1;
+        if(is_op("["))
+        {
+          at++;
+          count = expr();
+          if(!is_op("]")) fail("missing ]", NULL);
+          at++;
+        }
+        while(count-- > 0) emit(v, size);
+      }
+      if(is_op(",")) at++;
+      else if(tok[at].type != T_END) fail("unexpected", tok[at].text);
+    }
+  }
+  else
+  {
+    unsigned int code = assemble(cond);
+    emit(code, 4);
+  }
+  if(listing && pass == 2)
+  {
+    printf("%03lX ", lineCog);
+    if(hubHere > lineHub && hubHere - lineHub <= 4)
+    {
+      unsigned int v = 0;
+      for(long i = lineHub; i < hubHere; i++) v |= image[i] << (8 * (i - lineHub));
+      printf("%08X ", v);
+    }
+    else printf("         ");
+    printf("%s\n", l->text);
+  }
+}
+
+static void con_line(const char *text)
+{
+  static long enumValue;
+  tokenize(text);
+  while(tok[at].type != T_END)
+  {
+    if(is_op("#"))
+    {
+      at++;
+      enumValue = expr();
+    }
+    else if(tok[at].type == T_ID)
+    {
+      char name[64];
+      snprintf(name, sizeof(name), "%s", tok[at].text);
+      at++;
+      if(is_op("="))
+      {
+        at++;
+        sym_set(name, expr());
+      }
+      else
+      {
+        long step = 1;
+        if(is_op("["))
+        {
+          at++;
+          step = expr();
+          at++;
+        }
+        sym_set(name, enumValue);
+        enumValue += step;
+      }
+    }
+    else fail("unexpected", tok[at].text);
+    if(is_op(",")) at++;
+    else if(tok[at].type != T_END) fail("unexpected", tok[at].text);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  const char *name = NULL, *out = NULL;
+  int i;
+  for(i = 1; i < argc && argv[i][0] == '-'; i++)
+  {
+    if(!strcmp(argv[i], "-l")) listing = 1;
+    else if(!strcmp(argv[i], "-n") && i + 1 < argc) name = argv[++i];
+    else break;
+  }
+  if(argc - i != 2)
+  {
+    fprintf(stderr, "usage: spinasm [-l] [-n name] file.spin out.c|out.dat\n");
+    return 2;
+  }
+  file = argv[i];
+  out = argv[i + 1];
+
+  char *src = read_source(file);              // Split into sections
+  int section = 0, n = 1;
+  for(char *p = src; *p; n++)
+  {
+    char *end = strchr(p, '\n');
+    if(end) *end = 0;
+    char word[4] = "";
+    for(int k = 0; k < 3 && isalpha((unsigned char) p[k]); k++)
+      word[k] = toupper((unsigned char) p[k]);
+    word[3] = 0;
+    if(strlen(word) == 3 && !isalnum((unsigned char) p[3]) && p[3] != '_')
+    {
+      static const char *names[] = {"CON", "VAR", "OBJ", "PUB", "PRI", "DAT"};
+      for(int k = 0; k < 6; k++)
+        if(!strcmp(word, names[k]))
+        {
+          section = k;
+          p += 3;
+        }
+    }
+    if(section == 0 || section == 5)
+    {
+      if(nlines == MAX_LINES) fail("too many lines", NULL);
+
+      lines[nlines].line = section == 0 ? -n : n;     // CON lines negative
+      lines[nlines++].text = p;
+    }
+    if(!end) break;
+    p = end + 1;
+  }
+
+  for(pass = 1; pass <= 2; pass++)
+  {
+    hubHere = orgHub = orgCog = resCog = 0;
+    scope[0] = 0;
+    for(int k = 0; k < nlines; k++)
+    {
+      unresolved = 0;
+      if(lines[k].line < 0)
+      {
+        curLine = -lines[k].line;
+        if(pass == 1) con_line(lines[k].text);
+      }
+      else dat_line(&lines[k]);
+    }
+  }
+
+  long longs = (hubHere + 3) / 4;
+  FILE *f = fopen(out, "wb");
+  if(!f) fail("cannot write", out);
+  size_t len = strlen(out);
+  if(len > 2 && !strcmp(out + len - 2, ".c"))
+  {
+    char base[128];
+    if(!name)
+    {
+      const char *b = strrchr(file, '/');
+      b = b ? b + 1 : file;
+      snprintf(base, sizeof(base), "%s", b);
+      char *dot = strrchr(base, '.');
+      if(dot) *dot = 0;
+      name = base;
+    }
+    long padded = longs < 496 ? 496 : longs;
+    fprintf(f, "/* Generated by spinasm from %s. */\n\n", file);
+    fprintf(f, "unsigned int binary_%s_dat_start[%ld] = {\n", name, padded);
+    for(long k = 0; k < longs; k++)
+    {
+      unsigned int v = image[4 * k] | image[4 * k + 1] << 8 |
+                       image[4 * k + 2] << 16 | (unsigned int) image[4 * k + 3] << 24;
+      fprintf(f, "%s0x%08X,%s", k % 6 ? " " : "  ", v, k % 6 == 5 ? "\n" : "");
+    }
+    fprintf(f, "%s};\n", longs % 6 ? "\n" : "");
+    fprintf(f, "\n__asm__(\".globl binary_%s_dat_end\\n\"\n"
+            "        \".set binary_%s_dat_end, binary_%s_dat_start + %ld\");\n",
+            name, name, name, hubHere);
+  }
+  else fwrite(image, 1, hubHere, f);
+  fclose(f);
+  return 0;
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
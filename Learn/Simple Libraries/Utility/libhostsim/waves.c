@@ -0,0 +1,238 @@
+/*
+ * @file waves.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Pin waveforms for libhostsim: Value Change Dump (VCD) capture,
+ * and checkers that hold pulses on a pin to a protocol's timing.
+ *
+ * @detail Both work from one pin watcher.  VCD times are in picoseconds,
+ * so each system clock tick is a whole number of them at 80 MHz.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hostsim.h"
+
+#define CHECKS 16
+#define REPORTS 5                             // Violations printed per check
+
+enum {CHECK_WS2812, CHECK_SERVO};
+
+typedef struct
+{
+  int type, pin;
+  int min[2], max[2];                         // Ticks, for 0/1 or pulse/frame
+  int reset;                                  // WS2812 low that ends a frame
+  sim_time_t rise, fall;                      // Last edges, 0 for none
+  int bits;                                   // WS2812 bits this frame
+  int count, errors;
+} check_t;
+
+static struct
+{
+  FILE *vcd;
+  unsigned int mask, pins;
+  unsigned long long psPerTick;
+  check_t check[CHECKS];
+  int checks, watching;
+} w;
+
+static void watch(sim_time_t t, unsigned int pins, unsigned int changed);
+
+
+
+/* Value Change Dump */
+
+static void vcd_close(void)
+{
+  if(!w.vcd) return;
+  fclose(w.vcd);
+  w.vcd = NULL;
+}
+
+int sim_vcd_open(const char *file, unsigned int mask)
+{
+  static int exiting;
+  vcd_close();
+  FILE *f = fopen(file, "w");
+  if(!f) return -1;
+  if(!w.watching++) sim_watch(watch);
+  if(!exiting++) atexit(vcd_close);
+  w.psPerTick = 1000000000000ULL / CLKFREQ;
+  w.mask = mask;
+  w.pins = sim_pins();
+  fprintf(f, "$version libhostsim $end\n$timescale 1 ps $end\n");
+  fprintf(f, "$scope module propeller $end\n");
+  for(int pin = 0; pin < 32; pin++)
+    if(mask & (1u << pin)) fprintf(f, "$var wire 1 %c P%d $end\n", '!' + pin, pin);
+  fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+  fprintf(f, "#%llu\n$dumpvars\n", sim_now() * w.psPerTick);
+  for(int pin = 0; pin < 32; pin++)
+    if(mask & (1u << pin)) fprintf(f, "%d%c\n", (w.pins >> pin) & 1, '!' + pin);
+  fprintf(f, "$end\n");
+  w.vcd = f;
+  return 0;
+}
+
+void sim_vcd_close(void)
+{
+  vcd_close();
+}
+
+static void vcd_write(sim_time_t t, unsigned int pins, unsigned int changed)
+{
+  changed &= w.mask;
+  if(!changed) return;
+  fprintf(w.vcd, "#%llu\n", t * w.psPerTick);
+  for(int pin = 0; pin < 32; pin++)
+    if(changed & (1u << pin)) fprintf(w.vcd, "%d%c\n", (pins >> pin) & 1, '!' + pin);
+}
+
+
+
+/* Timing checkers */
+
+static void violation(check_t *k, sim_time_t t, const char *what, int ticks)
+{
+  static const char *names[] = {"ws2812", "servo"};
+  if(k->errors++ < REPORTS)
+    fprintf(stderr, "hostsim: P%d %s %s %d ns at %.1f us\n", k->pin,
+            names[k->type], what, (int) (ticks * w.psPerTick / 1000),
+            t * w.psPerTick / 1e6);
+}
+
+static void ws2812_edge(check_t *k, sim_time_t t, int high)
+{
+  if(high)
+  {
+    if(k->bits && t - k->fall >= (sim_time_t) k->reset)  // Reset ends frame
+    {
+      if(k->bits % 24 && k->errors++ < REPORTS)
+        fprintf(stderr, "hostsim: P%d ws2812 frame of %d bits at %.1f us\n",
+                k->pin, k->bits, t * w.psPerTick / 1e6);
+      k->bits = 0;
+    }
+    k->rise = t;
+    return;
+  }
+  if(!k->rise) return;
+  int ticks = (int) (t - k->rise);
+  k->fall = t;
+  k->count++;
+  k->bits++;
+  if((ticks < k->min[0] || ticks > k->max[0]) &&
+     (ticks < k->min[1] || ticks > k->max[1]))
+    violation(k, t, "high", ticks);
+}
+
+static void servo_edge(check_t *k, sim_time_t t, int high)
+{
+  if(high)
+  {
+    if(k->rise)
+    {
+      int frame = (int) (t - k->rise);
+      if(frame < k->min[1] || frame > k->max[1])
+        violation(k, t, "frame", frame);
+    }
+    k->rise = t;
+    return;
+  }
+  if(!k->rise) return;
+  int ticks = (int) (t - k->rise);
+  k->count++;
+  if(ticks < k->min[0] || ticks > k->max[0]) violation(k, t, "pulse", ticks);
+}
+
+static int check_add(int type, int pin)
+{
+  if(w.checks == CHECKS) return -1;
+  if(!w.watching++) sim_watch(watch);
+  if(!w.psPerTick) w.psPerTick = 1000000000000ULL / CLKFREQ;
+  check_t *k = &w.check[w.checks];
+  k->type = type;
+  k->pin = pin;
+  return w.checks++;
+}
+
+int sim_check_ws2812(int pin, int t0hMin, int t0hMax, int t1hMin, int t1hMax)
+{
+  int id = check_add(CHECK_WS2812, pin);
+  if(id < 0) return id;
+  int us = CLKFREQ / 1000000;
+  w.check[id].min[0] = t0hMin * us / 1000;
+  w.check[id].max[0] = t0hMax * us / 1000;
+  w.check[id].min[1] = t1hMin * us / 1000;
+  w.check[id].max[1] = t1hMax * us / 1000;
+  w.check[id].reset = 50 * us;
+  return id;
+}
+
+int sim_check_servo(int pin)
+{
+  int id = check_add(CHECK_SERVO, pin);
+  if(id < 0) return id;
+  int us = CLKFREQ / 1000000;
+  w.check[id].min[0] = 400 * us;
+  w.check[id].max[0] = 2600 * us;
+  w.check[id].min[1] = 19000 * us;
+  w.check[id].max[1] = 21000 * us;
+  return id;
+}
+
+int sim_check_count(int id)
+{
+  return id >= 0 && id < w.checks ? w.check[id].count : 0;
+}
+
+int sim_check_errors(int id)
+{
+  return id >= 0 && id < w.checks ? w.check[id].errors : 0;
+}
+
+static void watch(sim_time_t t, unsigned int pins, unsigned int changed)
+{
+  if(w.vcd) vcd_write(t, pins, changed);
+  for(int i = 0; i < w.checks; i++)
+  {
+    check_t *k = &w.check[i];
+    if(!(changed & (1u << k->pin))) continue;
+    int high = (pins >> k->pin) & 1;
+    if(k->type == CHECK_WS2812) ws2812_edge(k, t, high);
+    else servo_edge(k, t, high);
+  }
+}
+
+void sim_waves_init(void)
+{
+  const char *file = getenv("HOSTSIM_VCD");
+  if(!file || !*file) return;
+  if(sim_vcd_open(file, 0xFFFFFFFF))
+    fprintf(stderr, "hostsim: cannot write %s\n", file);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
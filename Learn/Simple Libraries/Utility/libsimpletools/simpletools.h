@@ -28,7 +28,7 @@
  * @li Serial Communication - SPI, I2C
  * @n For half and full duplex asynchronous serial communication, see 
  * ...Learn/Simple Libraries/Text Devices
- * @li Memory - EEPROM, SD storage
+ * @li Memory - EEPROM, SD storage, fixed-block memory pools
  *
  * Applications include: monitoring, control and
  * communication with simple peripherals, like lights, buttons,
@@ -50,14 +50,47 @@
  * and leave it launched for set it/forget it processes:
  * 
  * @li cog_run (1 cog per call)
+ * @li pool_start (1 cog per worker)
  * @li squareWave (1 cog)
  * @li pwm (1 cog)
+ * @li pwm_multi (1 cog)
+ * @li pulse_capture (1 cog)
+ * @li pin_events_subscribe (1 cog for all subscribers)
  * @li dac (1 cog)
  *
  * @par Memory Models
  * Use with CMM, LMM.
  * 
  * @version
+ * 0.98.10 Add pin_events_subscribe and pin_events_ functions for queuing
+ * timestamped pin changes from one cog to any number of subscribers.
+ * @par
+ * 0.98.9 Add MAILBOX and mailbox_ functions for queuing requests to driver
+ * cogs.
+ * @par
+ * 0.98.8 Add cog_imageStore, cog_imageLoad and cog_imageStart for keeping
+ * PASM driver images in EEPROM and reusing their hub RAM.
+ * @par
+ * 0.98.7 Add TRACE_BEGIN, TRACE_END, trace_name, trace_dump and trace_clear 
+ * for timing code regions in any cog.
+ * @par
+ * 0.98.6 Add stack_monitor functions for checking how much of each cog's 
+ * stack has been used while the application runs.
+ * @par
+ * 0.98.5 Add MEM_POOL and mem_ functions for fixed-block memory pools.  cog_run 
+ * and cog_end get stack memory with mem_get and mem_put.
+ * @par
+ * 0.98.4 Add pool_ functions for running jobs in a pool of worker cogs.
+ * @par
+ * 0.98.3 Add ring_ functions for passing values between cogs through ring
+ * buffers.
+ * @par
+ * 0.98.2 Add pwm_multi functions for PWM on up to 32 pins from one cog.
+ * @par
+ * 0.98.1 Add pulse_capture_start, pulse_capture_high, pulse_capture_low,
+ * pulse_capture_edges, and pulse_capture_stop for measuring pulses on several
+ * pins at once in the background.
+ * @par
  * 0.98 fpucog floating point coprocessor no longer self-starts by default.  
  * All floating point functionality is still supported, processing just happens in
  * the same cog.  i2c_out and i2c_in char regAddr parameter changed to int memAddr. 
@@ -195,6 +228,18 @@ extern i2c *st_eeprom;
  */
 extern int st_eeInitFlag;
 
+/**
+ * @brief Set by stack_monitor_start.  Called by cog_run and library 
+ * functions that start cogs with the stack they are about to use.
+ */
+extern int (*st_stackAdd)(const char *name, void *stack, int stacksize);
+
+/**
+ * @brief Set by stack_monitor_start.  Called by cog_end with the stack of 
+ * the cog it stops.
+ */
+extern void (*st_stackRemove)(void *stack);
+
 
 /**
  * @}
@@ -949,6 +994,112 @@ void pwm_set(int pin, int channel, int tHigh);
  */
 void pwm_stop(void);
 
+#ifndef PWM_MULTI_GROUPS
+/**
+ * @brief Number of groups with independent cycle times that the pwm_multi
+ * cog can run.  
+ */
+#define PWM_MULTI_GROUPS 4
+#endif
+
+/**
+ * @brief Start a PWM cog that can drive up to 32 I/O pins.  
+ *
+ * @details pwm_start/pwm_set use the cog's two counter modules, so they are 
+ * limited to two signals.  The pwm_multi cog times each pin's high signal in 
+ * software instead.  Pins are organized into up to PWM_MULTI_GROUPS groups, 
+ * each with its own cycle time (pwm_multi_group).  Each pin is assigned a 
+ * group and a resolution (pwm_multi_pin), and its high time is set as a 
+ * level from 0 to that resolution (pwm_multi_set).  
+ *
+ * New levels do not take effect until pwm_multi_commit is called.  The cog 
+ * then switches each group to the new values at the start of its next cycle, 
+ * so a cycle never mixes old and new settings.  
+ *
+ * Example: Drive four LEDs on P0..P3 at 1 kHz with 256 brightness steps.
+ *
+ * @code
+ * pwm_multi_start();
+ * pwm_multi_group(0, 1000);
+ * for(int pin = 0; pin < 4; pin++) pwm_multi_pin(pin, 0, 256);
+ * pwm_multi_set(0, 16);  pwm_multi_set(1, 64);
+ * pwm_multi_set(2, 128); pwm_multi_set(3, 256);
+ * pwm_multi_commit();
+ * @endcode
+ *
+ * @note High times that end within a few microseconds of each other (CMM) 
+ * are handled late, because the cog needs that long to process each edge.  
+ * Pins that end at exactly the same time are handled together.  Use 
+ * pwm_multi_jitter to check the worst case.  
+ *
+ * A new cog (after pwm_multi_stop) starts with every group off; pin, group 
+ * and level settings are kept, and take effect with pwm_multi_commit.
+ *
+ * @returns Nonzero if the cog was started, or 0 if no cog was available.
+ */
+int pwm_multi_start(void);
+
+/**
+ * @brief Set the cycle time for a group of pwm_multi pins.
+ *
+ * @details Takes effect with the next pwm_multi_commit.
+ *
+ * @param group Group number, 0 to PWM_MULTI_GROUPS - 1.
+ * @param cycleMicroseconds Number of microseconds the PWM cycle lasts, or 0 to 
+ * turn the group off.
+ */
+void pwm_multi_group(int group, unsigned int cycleMicroseconds);
+
+/**
+ * @brief Assign an I/O pin to a pwm_multi group.
+ *
+ * @details The pin's level is reset to 0.  Takes effect with the next 
+ * pwm_multi_commit.  When a pin is removed from a group, the cog sets it 
+ * to input.  
+ *
+ * @param pin I/O pin number.
+ * @param group Group number, 0 to PWM_MULTI_GROUPS - 1, or -1 to remove the 
+ * pin from its group.
+ * @param resolution Number of steps in a full cycle, 1 to 65535.  For example,
+ * 100 lets pwm_multi_set levels work like percent, and 256 works with 8-bit 
+ * brightness values.  
+ */
+void pwm_multi_pin(int pin, int group, int resolution);
+
+/**
+ * @brief Set the high time of a pwm_multi pin.
+ *
+ * @details Takes effect with the next pwm_multi_commit.
+ *
+ * @param pin I/O pin number.
+ * @param level High time in steps of the pin's resolution.  0 is always low,
+ * and the resolution value is always high.  
+ */
+void pwm_multi_set(int pin, int level);
+
+/**
+ * @brief Hand the settings from pwm_multi_group, pwm_multi_pin, and 
+ * pwm_multi_set to the pwm_multi cog.  
+ *
+ * @details Each group switches to the new settings at the start of its next
+ * cycle.  If the previous commit has not been taken by every group yet, this 
+ * function waits for up to one cycle of the slowest group.
+ */
+void pwm_multi_commit(void);
+
+/**
+ * @brief Find out how late the pwm_multi cog has been for a scheduled edge.
+ *
+ * @returns Largest number of clock ticks an edge has been late since 
+ * pwm_multi_start.
+ */
+unsigned int pwm_multi_jitter(void);
+
+/**
+ * @brief Stop the pwm_multi cog and reclaim it for other uses.
+ */
+void pwm_multi_stop(void);
+
 /**
  * @brief Measure the duration of a pulse applied to an I/O pin
  *
@@ -997,6 +1148,200 @@ void pulse_out(int pin, int time);
  */
 long rc_time(int pin, int state);
 
+/**
+ * @brief Start a cog that measures pulses on a group of I/O pins in the 
+ * background.  
+ *
+ * @details Unlike pulse_in, which makes your code wait until the pulse
+ * is over, the pulse capture cog watches every pin in pinMask at the same
+ * time and keeps a table with the most recent high and low pulse widths 
+ * and an edge count for each pin.  Your code can check the table with 
+ * pulse_capture_high, pulse_capture_low, and pulse_capture_edges at any time 
+ * without waiting.  Calling this function again with a different mask 
+ * restarts the cog and clears the table.
+ *
+ * Pulses that are shorter than the time the capture cog takes to record 
+ * an edge (tens of microseconds in CMM) can be missed.
+ *
+ * @param pinMask Pins to watch.  For example, (1 << 8) | (1 << 9) watches 
+ * P8 and P9.
+ *
+ * @returns Nonzero if the cog was started, or 0 if no cog was available.
+ */
+int pulse_capture_start(unsigned int pinMask);
+
+/**
+ * @brief Get the most recent high pulse width measured on a pin by the
+ * pulse capture cog.
+ *
+ * @details Default time increments are specified in 1 microsecond units.  
+ * Unit size can be changed with a call to set_io_dt function.  
+ *
+ * @param pin I/O pin number.  It has to be included in the pinMask passed 
+ * to pulse_capture_start.
+ *
+ * @returns Number of time units the most recent high pulse lasted, or 0 if 
+ * no complete high pulse has been measured yet.
+ */
+long pulse_capture_high(int pin);
+
+/**
+ * @brief Get the most recent low pulse width measured on a pin by the
+ * pulse capture cog.
+ *
+ * @details Default time increments are specified in 1 microsecond units.  
+ * Unit size can be changed with a call to set_io_dt function.  
+ *
+ * @param pin I/O pin number.  It has to be included in the pinMask passed 
+ * to pulse_capture_start.
+ *
+ * @returns Number of time units the most recent low pulse lasted, or 0 if 
+ * no complete low pulse has been measured yet.
+ */
+long pulse_capture_low(int pin);
+
+/**
+ * @brief Get the number of edges (low to high and high to low transitions)
+ * the pulse capture cog has counted on a pin.
+ *
+ * @details Compare with a value saved earlier to find out if a new pulse 
+ * has arrived since the last time you checked.
+ *
+ * @param pin I/O pin number.
+ *
+ * @returns Number of edges since pulse_capture_start.
+ */
+unsigned int pulse_capture_edges(int pin);
+
+/**
+ * @brief Stop the pulse capture cog and reclaim it for other uses.
+ */
+void pulse_capture_stop(void);
+
+/**
+ * @brief A pin change recorded by the pin events cog.
+ */
+typedef struct pin_event_st
+{
+  unsigned int time;                          // CNT when the pin changed
+  char pin;                                   // I/O pin number
+  char edge;                                  // 1 low to high, 0 high to low
+} pin_event_t;
+
+/**
+ * @brief Subscriber to the pin events cog.
+ */
+typedef struct pin_events_st
+{
+  unsigned int mask;                          // Pins to get events for
+  volatile int head;                          // Next event, events cog only
+  volatile int tail;                          // Oldest event, subscriber only
+  int size;                                   // Events in buf
+  pin_event_t *buf;                           // Event storage
+  volatile int dropped;                       // Events lost, buf was full
+  int backoff;                                // Longest waitcnt, 0 to spin
+  struct pin_events_st *next;                 // Next subscriber
+} pin_events_t;
+
+/**
+ * @brief Get events for changes on a group of I/O pins from a cog that
+ * watches them in the background.  Starts the pin events cog if it is not
+ * already running.
+ *
+ * @details Code that waits for a pin with input in a loop keeps its cog
+ * busy, and can miss a short pulse while it is doing something else.  The
+ * pin events cog waits for any subscribed pin to change with waitpne,
+ * which takes no hub access while nothing happens, then records the pin,
+ * the edge, and CNT at the moment it saw the change.  Each subscriber gets
+ * its own queue of events for its own pins, so several libraries can watch
+ * pins through one cog.  A subscriber can check its queue any time with
+ * pin_events_get or pin_events_getBatch, or wait for the next event with
+ * pin_events_wait.
+ *
+ * Subscribing restarts the cog with the new group of pins.  Changes closer
+ * together than the time the cog takes to record an event (tens of
+ * microseconds in CMM) can be seen as one change, or missed if a pin
+ * changes twice.  If a queue is full, its new events are counted in the
+ * subscriber's dropped field instead.
+ *
+ * @param *sub Address of a pin_events_t variable for this subscriber.
+ * @param pinMask Pins to get events for.  For example, (1 << 3) | (1 << 4)
+ * is P3 and P4.
+ * @param *buf Array for queued events.
+ * @param size Number of elements in buf.  The queue can hold up to
+ * size - 1 events.
+ *
+ * @returns Nonzero if the cog is running, or 0 if no cog was available.
+ */
+int pin_events_subscribe(pin_events_t *sub, unsigned int pinMask,
+                         pin_event_t *buf, int size);
+
+/**
+ * @brief Stop getting events.  Restarts the pin events cog with the pins
+ * the other subscribers need, or stops it if there are none.
+ *
+ * @param *sub Address of the subscriber's pin_events_t variable.
+ */
+void pin_events_unsubscribe(pin_events_t *sub);
+
+/**
+ * @brief Get the oldest event from a subscriber's queue.  Does not wait.
+ *
+ * @param *sub Address of the subscriber's pin_events_t variable.
+ * @param *event Address of a pin_event_t variable to receive the event.
+ *
+ * @returns 1 if an event was received, or 0 if the queue was empty.
+ */
+int pin_events_get(pin_events_t *sub, pin_event_t *event);
+
+/**
+ * @brief Get up to n of the oldest events from a subscriber's queue.
+ * Does not wait.
+ *
+ * @param *sub Address of the subscriber's pin_events_t variable.
+ * @param *events Array to receive the events.
+ * @param n Number of elements in the array.
+ *
+ * @returns Number of events received.
+ */
+int pin_events_getBatch(pin_events_t *sub, pin_event_t *events, int n);
+
+/**
+ * @brief Make pin_events_wait check a subscriber's queue less often, to
+ * save hub access and power.  The first wait is 10 us, and each one after
+ * that is twice as long, up to the maximum.  Event times still come from
+ * the pin events cog, so they stay exact.
+ *
+ * @param *sub Address of the subscriber's pin_events_t variable.
+ * @param ticks Longest wait between checks, in system clock ticks.  The
+ * default is 0.1 ms (CLKFREQ / 10000).  Anything below 800 means check
+ * continuously.
+ */
+void pin_events_backoff(pin_events_t *sub, int ticks);
+
+/**
+ * @brief Wait for the next event in a subscriber's queue.
+ *
+ * @param *sub Address of the subscriber's pin_events_t variable.
+ * @param *event Address of a pin_event_t variable to receive the event.
+ */
+void pin_events_wait(pin_events_t *sub, pin_event_t *event);
+
+/**
+ * @brief Find out how many events are waiting in a subscriber's queue.
+ *
+ * @param *sub Address of the subscriber's pin_events_t variable.
+ *
+ * @returns Number of events that pin_events_get can receive.
+ */
+int pin_events_count(pin_events_t *sub);
+
+/**
+ * @brief Stop the pin events cog and reclaim it for other uses.
+ * Subscribers keep their queued events.
+ */
+void pin_events_stop(void);
+
 /**
  * @brief Make I/O pin transmit a repeated high/low signal at a certain frequency.
  * High and low times are the same.  Frequency can range from 1 Hz to 128 MHz.  
@@ -1366,6 +1711,430 @@ int sd_mount(int doPin, int clkPin, int diPin, int csPin);
 
 
 
+/**
+ * @}
+ *
+ * @name Memory Pools
+ * @{
+ */
+
+
+
+/**
+ * @brief Fixed-size block memory pool.  Declare with MEM_POOL.
+ */
+typedef struct mem_pool_st
+{
+  const char *name;                           // Name for mem_stats
+  int blockSize;                              // Bytes per block
+  int blocks;                                 // Blocks in storage
+  void *storage;                              // Block storage
+  void *freeList;                             // Freed blocks
+  int fresh;                                  // Blocks ever handed out
+  int used;                                   // Blocks in use now
+  int highWater;                              // Most blocks ever in use
+  struct mem_pool_st *next;                   // Next pool, by blockSize
+} mem_pool_t;
+
+/**
+ * @brief Declare a memory pool with a certain number of blocks of a certain
+ * size, and add it to the pools that mem_get uses.  Use at file level 
+ * (outside any function), for example MEM_POOL(stacks, 300, 2).
+ *
+ * @details malloc takes memory for library drivers, stacks and buffers from 
+ * the heap, and free gives it back.  Repeatedly opening and closing drivers 
+ * can leave the heap in small pieces that are too small for the next request,
+ * and the time malloc takes depends on the heap's condition.  A memory pool 
+ * sets aside memory for a fixed number of same-size blocks when the program 
+ * is built.  Getting or returning a block always takes the same short time, 
+ * and never breaks up the heap.  
+ *
+ * Library functions that open drivers and start cogs (cog_run, fdserial_open,
+ * colorPal_open, rfid_open, vgatext_open, ...) get their memory with 
+ * mem_get, so declaring a pool with blocks of the right size is all it takes
+ * to move them out of the heap.  Use mem_stats to see how many blocks each 
+ * pool actually needs.  Blocks can be got and returned from any cog; the 
+ * pools share one lock (see locknew), taken when the first pool is added.
+ *
+ * @param name Name for the pool's mem_pool_t variable.
+ * @param size Number of bytes in each block (rounded up to a multiple of 4).
+ * @param count Number of blocks.
+ */
+#define MEM_POOL(name, size, count) \
+  static int name##_storage[(count) * (((size) + 3) / 4)]; \
+  mem_pool_t name = {#name, ((size) + 3) & ~3, (count), name##_storage}; \
+  __attribute__((constructor)) static void name##_add(void) \
+  { mem_poolAdd(&name); }
+
+/**
+ * @brief Add a pool to the ones mem_get uses.  MEM_POOL does this 
+ * automatically.
+ *
+ * @param *pool Address of the pool.
+ */
+void mem_poolAdd(mem_pool_t *pool);
+
+/**
+ * @brief Get a block from a certain pool.
+ *
+ * @param *pool Address of the pool.
+ *
+ * @returns Address of the block, or 0 if all of the pool's blocks are in use.
+ */
+void *mem_alloc(mem_pool_t *pool);
+
+/**
+ * @brief Return a block to the pool it came from.
+ *
+ * @param *pool Address of the pool.
+ * @param *ptr Address returned by mem_alloc.
+ */
+void mem_free(mem_pool_t *pool, void *ptr);
+
+/**
+ * @brief Get memory for a driver, stack or buffer.  
+ *
+ * @details Takes a block from the smallest pool with big enough blocks that
+ * still has one available.  If there is none, it uses malloc instead.
+ *
+ * @param size Number of bytes needed.
+ *
+ * @returns Address of the memory, or 0 if none was available.
+ */
+void *mem_get(int size);
+
+/**
+ * @brief Return memory from mem_get.  Blocks go back to their pool, and 
+ * anything else goes back to the heap with free.
+ *
+ * @param *ptr Address returned by mem_get.
+ */
+void mem_put(void *ptr);
+
+/**
+ * @brief Display each pool's block size, number of blocks, blocks in use, 
+ * and high-water mark (most blocks ever in use at once), plus the number of 
+ * mem_get requests that went to the heap.  Hub RAM freed by
+ * cog_imageStore is listed as "cog image" pools.
+ */
+void mem_stats(void);
+
+
+
+/**
+ * @}
+ *
+ * @name Cog Images in EEPROM
+ * @{
+ */
+
+
+
+#ifndef COG_IMAGE_MAX
+/**
+ * @brief Maximum number of PASM images cog_imageStore can keep track of.
+ */
+#define COG_IMAGE_MAX 4
+#endif
+
+/**
+ * @brief Keep a copy of a driver's PASM image in EEPROM, and give the hub
+ * RAM it occupies to mem_get.  Call at the start of main, before starting
+ * any driver that uses the image.
+ *
+ * @details cognew copies a PASM image into a cog, but the image stays in
+ * hub RAM afterwards, from a few hundred bytes up to nearly 2 KB per
+ * driver.  After cog_imageStore, that hub RAM is a memory pool named "cog
+ * image" that mem_stats lists with the number of bytes freed, and that
+ * fdserial_open, vgatext_open, stacks and buffers can use.  Drivers that
+ * launch with cog_imageLoad and cog_imageStart (fdserial, colorPal, 
+ * rfidser, ws2812, adcACpropab) read the image back from EEPROM into a mem_get block each
+ * time they start a cog, and return the block once the cog has copied it.
+ * Do not store images for drivers that call cognew themselves.
+ *
+ * EEPROM is only written if its copy is different, so calling this each
+ * time the program starts does not wear it out.  Use addresses from 32768
+ * up, in a 64 KB EEPROM, that nothing else uses.  For example:
+ *
+ *   extern int binary_pst_dat_start[], binary_pst_dat_end[];
+ *   cog_imageStore(binary_pst_dat_start,
+ *                  (char *) binary_pst_dat_end - (char *) binary_pst_dat_start,
+ *                  40000);
+ *
+ * @param *image Address of the PASM image (binary_..._dat_start symbol).
+ * @param bytes Size of the image.
+ * @param eeAddr EEPROM address for the copy.
+ *
+ * @returns Number of hub RAM bytes freed (0 in XMM models, where the image
+ * is not in hub RAM, or if COG_IMAGE_MAX images are already stored).
+ */
+int cog_imageStore(const void *image, int bytes, int eeAddr);
+
+/**
+ * @brief Get a PASM image ready to launch.  Library drivers use this with
+ * cog_imageStart in place of cognew.
+ *
+ * @param *image Address of the PASM image.
+ *
+ * @returns The image itself, or a mem_get block holding the image read from
+ * EEPROM if it was stored with cog_imageStore (0 if no memory was
+ * available).  A driver can change settings in its copy before launching.
+ */
+void *cog_imageLoad(const void *image);
+
+/**
+ * @brief Start a cog with an image from cog_imageLoad.  Waits for the cog
+ * to copy the image, so the driver can change the image's settings again
+ * for its next cog, and then if the image came from EEPROM, returns its
+ * block with mem_put.
+ *
+ * @param *image Address of the PASM image, as passed to cog_imageLoad.
+ * @param *code Address cog_imageLoad returned.
+ * @param *par Value for the cog's PAR register.
+ *
+ * @returns Cog ID, or -1 if no cog or memory was available.
+ */
+int cog_imageStart(const void *image, void *code, void *par);
+
+
+
+/**
+ * @}
+ *
+ * @name Stack Monitor
+ * @{
+ */
+
+
+
+#ifndef STACK_MONITOR_MAX
+/**
+ * @brief Maximum number of stacks the stack monitor can keep track of.
+ */
+#define STACK_MONITOR_MAX 8
+#endif
+
+/**
+ * @brief Start keeping track of the stacks cog_run and library functions 
+ * use when they launch cogs.  Call before starting the cogs to check.
+ *
+ * @details Sizing a cog's stack usually takes guessing, or a separate 
+ * test run with the stacktest library.  The stack monitor checks stacks 
+ * while the application itself runs.  Before each cog starts, its stack 
+ * is filled with a known pattern.  The stack grows down from the top, so 
+ * the lowest long that no longer matches the pattern marks the most of the
+ * stack the cog has ever used.  Checking only reads the stack, so it does 
+ * not slow the cog down, and can be repeated any time with 
+ * stack_monitor_used or stack_monitor_report.
+ *
+ * Library functions that start cogs with a stack of their own (pwm_start,
+ * square_wave, dac_ctr, drive_ functions, servo_ functions, ...) register 
+ * their stacks as they launch, so start the monitor before those too.
+ */
+void stack_monitor_start(void);
+
+/**
+ * @brief Fill a stack with the monitor's pattern and start keeping track of
+ * it.  Call before passing the stack to cogstart.  cog_run does this 
+ * automatically after stack_monitor_start.
+ *
+ * @param *name Name to display in stack_monitor_report.
+ * @param *stack Address of the stack array.
+ * @param stacksize Number of bytes in the stack array.
+ *
+ * @returns Stack ID for the other stack_monitor functions, or -1 if 
+ * STACK_MONITOR_MAX stacks are already being checked.
+ */
+int stack_monitor_add(const char *name, void *stack, int stacksize);
+
+/**
+ * @brief Stop keeping track of a stack.  cog_end does this automatically.
+ *
+ * @param *stack Address of the stack array.
+ */
+void stack_monitor_remove(void *stack);
+
+/**
+ * @brief Get the name a stack was added with.
+ *
+ * @param id Stack ID from stack_monitor_add (0 to STACK_MONITOR_MAX - 1).
+ *
+ * @returns Address of the name, or 0 if no stack has that ID.
+ */
+const char *stack_monitor_name(int id);
+
+/**
+ * @brief Get the size of a stack.
+ *
+ * @param id Stack ID.
+ *
+ * @returns Number of int variables in the stack.
+ */
+int stack_monitor_size(int id);
+
+/**
+ * @brief Get the most of a stack its cog has used so far.
+ *
+ * @param id Stack ID.
+ *
+ * @returns Number of int variables used.  If it equals stack_monitor_size,
+ * the stack may have overflowed.
+ */
+int stack_monitor_used(int id);
+
+/**
+ * @brief Display the name, address, size, used and spare int variables of 
+ * each stack being checked.
+ */
+void stack_monitor_report(void);
+
+
+
+/**
+ * @}
+ *
+ * @name Tracing
+ * @{
+ */
+
+
+
+#ifndef TRACE_DEPTH
+/**
+ * @brief Number of records each cog's trace buffer holds (power of 2).  
+ */
+#define TRACE_DEPTH 32
+#endif
+
+#ifndef TRACE_ID_ABDRIVE
+/**
+ * @brief Trace ID the abdrive library uses for its encoders cog's 50 Hz 
+ * control update, when the library is built with TRACE_ON.  IDs 240 and
+ * up are used by libraries.
+ */
+#define TRACE_ID_ABDRIVE 240
+#endif
+
+#ifndef TRACE_ID_GPS
+/**
+ * @brief Trace ID the gps library uses for parsing each NMEA sentence,
+ * when the library is built with TRACE_ON.
+ */
+#define TRACE_ID_GPS 241
+#endif
+
+/**
+ * @brief One cog's trace records.  Only that cog adds records, and only 
+ * trace_dump removes them, so no lock is needed.
+ */
+typedef struct trace_buf_st
+{
+  volatile unsigned int head;                 // Records added (by its cog)
+  volatile unsigned int tail;                 // Records removed (by dump)
+  volatile unsigned int dropped;              // Records lost to a full buffer
+  volatile unsigned int rec[TRACE_DEPTH][2];  // CNT, type << 16 | id
+} trace_buf_t;
+
+/**
+ * @brief Trace buffers, one for each cog.
+ */
+extern trace_buf_t trace_buf[8];
+
+/**
+ * @brief Add a record to the trace buffer of the cog executing this code.
+ * Used by TRACE_BEGIN and TRACE_END.
+ *
+ * @param id Region ID (0 to 65535).
+ * @param type 'B' for beginning or 'E' for end of a region.
+ */
+static inline void trace_put(int id, int type)
+{
+  unsigned int t = CNT;
+  trace_buf_t *b = &trace_buf[cogid()];
+  unsigned int h = b->head;
+  if(h - b->tail >= TRACE_DEPTH)
+  {
+    b->dropped++;
+    return;
+  }
+  b->rec[h & (TRACE_DEPTH - 1)][0] = t;
+  b->rec[h & (TRACE_DEPTH - 1)][1] = (type << 16) | (id & 0xFFFF);
+  b->head = h + 1;
+}
+
+#ifdef TRACE_ON
+/**
+ * @brief Mark the beginning of a code region to time.  
+ *
+ * @details TRACE_BEGIN and TRACE_END record which cog, which region, and 
+ * the system clock (CNT) into a buffer for the cog that runs them.  They 
+ * take only a few instructions, so they can go in busy loops in any cog.  
+ * Call trace_dump from time to time to send the records to a terminal or
+ * fdserial connection, and save what arrives in a file.  The tracedump 
+ * program in this library's tools folder turns the file into a timeline 
+ * for chrome://tracing or Perfetto, or folded stacks for a flame graph, and
+ * lists each region's minimum, average and maximum clock ticks.
+ *
+ * TRACE_BEGIN and TRACE_END do nothing unless TRACE_ON is defined before
+ * simpletools.h is included (or with -D TRACE_ON in Project Options), so 
+ * they can stay in the code.  Regions in the same cog can nest, but have 
+ * to end in the reverse order they began.
+ *
+ * TRACE_ON only affects the files compiled with it.  The abdrive and gps
+ * regions (TRACE_ID_ABDRIVE, TRACE_ID_GPS) are in those libraries' own
+ * code, and the libraries that come with SimpleIDE are built without
+ * TRACE_ON, so their records only appear after the library is rebuilt
+ * with -D TRACE_ON.
+ *
+ * @param id Region ID (0 to 239).  Give it a name with trace_name.
+ */
+#define TRACE_BEGIN(id) trace_put((id), 'B')
+
+/**
+ * @brief Mark the end of a code region started with TRACE_BEGIN.
+ *
+ * @param id Region ID used with TRACE_BEGIN.
+ */
+#define TRACE_END(id) trace_put((id), 'E')
+#else
+#define TRACE_BEGIN(id)
+#define TRACE_END(id)
+#endif
+
+/**
+ * @brief Give a region ID a name for the timeline.
+ *
+ * @param id Region ID.
+ * @param *name Name to display.
+ */
+void trace_name(int id, const char *name);
+
+/**
+ * @brief Send each cog's trace records to a terminal, fdserial connection, 
+ * or other simpletext device, and empty the buffers.  Cogs can keep adding 
+ * records while this runs.
+ *
+ * @details Each line is one record: B (begin) or E (end), cog, region ID,
+ * and CNT in hexadecimal.  Lines starting with C give the system clock 
+ * frequency, N a region name, and D the number of records a cog lost 
+ * because its buffer was full.  Call it often enough that buffers do not
+ * fill, or increase TRACE_DEPTH.
+ *
+ * @param *device Device identifier from fdserial_open, simpleterm_pointer,
+ * etc.
+ *
+ * @returns Number of records sent.
+ */
+int trace_dump(text_t *device);
+
+/**
+ * @brief Discard all trace records and dropped record counts.  Only call 
+ * this while no cogs are running TRACE_BEGIN or TRACE_END.
+ */
+void trace_clear(void);
+
+
+
 /**
  * @}
  *
@@ -1426,6 +2195,360 @@ int cog_num(int *coginfo);
 void cog_end(int *coginfo);
 
 
+#ifndef POOL_JOBS
+/**
+ * @brief Number of jobs that can be waiting in the worker cog pool's queue.
+ */
+#define POOL_JOBS 16
+#endif
+
+#ifndef POOL_STACK
+/**
+ * @brief Default number of extra int variables in each worker cog's stack.
+ * Change with pool_stack.
+ */
+#define POOL_STACK 128
+#endif
+
+/**
+ * @brief Set the stack size for worker cogs launched by the next call to
+ * pool_start.
+ *
+ * @param stacksize Number of extra int variables for local variable 
+ * declarations and call/return stack, like cog_run's stacksize parameter.  
+ * It has to cover the job function that needs the most.
+ */
+void pool_stack(int stacksize);
+
+/**
+ * @brief Start a pool of worker cogs that run functions for you.
+ *
+ * @details cog_run starts a new cog each time it is called, and cog_end 
+ * stops it.  Starting a cog involves loading it, which takes time.  Worker 
+ * cogs are started once, then wait for jobs passed to pool_submit.  Whichever 
+ * worker is free first takes the next job.  This makes it practical to split
+ * work into small pieces and hand them to several cogs at once.
+ *
+ * @param nCogs Number of worker cogs to start.
+ *
+ * @returns Number of worker cogs started, which can be less than nCogs if
+ * not enough cogs (or no lock) were available.
+ */
+int pool_start(int nCogs);
+
+/**
+ * @brief Give a job to the worker cog pool.
+ *
+ * @details If POOL_JOBS jobs are already waiting, this function waits until
+ * a worker takes one.  Jobs are taken in the order they were submitted, but 
+ * jobs that are running in different worker cogs can finish in any order.
+ *
+ * @param *function Function for a worker cog to run, like void myJob(void *par).
+ *
+ * @param *par Value passed to the function, typically the address of a 
+ * structure with the job's inputs and outputs.
+ *
+ * @returns Handle for pool_wait or pool_done, or -1 if no pool is running.
+ */
+int pool_submit(void (*function)(void *par), void *par);
+
+/**
+ * @brief Check if a job is finished without waiting.
+ *
+ * @param handle Value returned by pool_submit.
+ *
+ * @returns 1 if the job is finished, 0 if it is still waiting or running.
+ */
+int pool_done(int handle);
+
+/**
+ * @brief Wait until a job is finished.
+ *
+ * @param handle Value returned by pool_submit.
+ */
+void pool_wait(int handle);
+
+/**
+ * @brief Stop the worker cogs and free their stacks.  Jobs that have not 
+ * finished are abandoned.
+ */
+void pool_stop(void);
+
+
+/**
+ * @brief Ring buffer for passing int values from one cog to another.  
+ * Declare one as a global variable and set it up with ring_init or
+ * ring_initMulti.
+ */
+typedef struct ring_st
+{
+  volatile int head;                          // Next write, producer only
+  volatile int tail;                          // Next read, consumer only
+  int size;                                   // Elements in buf
+  volatile int *buf;                          // Element storage
+  int lock;                                   // Lock ID, -1 if none
+} ring_t;
+
+/**
+ * @brief Simpler type name for use with SimpleIDE.
+ */
+typedef ring_t ring;
+
+/**
+ * @brief Set up a ring buffer for one cog that puts values in (producer) and 
+ * one cog that gets them out (consumer).  
+ *
+ * @details Sharing values through a ring buffer instead of volatile global
+ * variables means the producer does not have to wait for the consumer to 
+ * pick up each value, and the consumer never reads a value the producer is
+ * in the middle of changing.  No lock is needed because the producer only
+ * changes where the next value goes, and the consumer only changes where 
+ * the next value comes from.  
+ *
+ * @param *r Address of the ring_t variable.
+ * @param *buf Array that holds the values.
+ * @param size Number of elements in buf.  The ring buffer can hold up to 
+ * size - 1 values.
+ */
+void ring_init(ring_t *r, int *buf, int size);
+
+/**
+ * @brief Set up a ring buffer that more than one cog can put values into 
+ * (but still only one cog gets values out).  
+ *
+ * @details Checks out a Propeller lock so that producers take turns.  Use 
+ * ring_close to return the lock when the ring buffer is no longer needed.
+ *
+ * @param *r Address of the ring_t variable.
+ * @param *buf Array that holds the values.
+ * @param size Number of elements in buf.
+ *
+ * @returns Lock ID, or -1 if no locks were available.
+ */
+int ring_initMulti(ring_t *r, int *buf, int size);
+
+/**
+ * @brief Return the lock a ring buffer checked out with ring_initMulti.
+ *
+ * @param *r Address of the ring_t variable.
+ */
+void ring_close(ring_t *r);
+
+/**
+ * @brief Put a value into a ring buffer.  Does not wait.
+ *
+ * @param *r Address of the ring_t variable.
+ * @param value Value to put.
+ *
+ * @returns 1 if the value was put, or 0 if the buffer was full.
+ */
+int ring_put(ring_t *r, int value);
+
+/**
+ * @brief Get the oldest value from a ring buffer.  Does not wait.
+ *
+ * @param *r Address of the ring_t variable.
+ * @param *value Address of variable to receive the value.
+ *
+ * @returns 1 if a value was received, or 0 if the buffer was empty.
+ */
+int ring_get(ring_t *r, int *value);
+
+/**
+ * @brief Put up to n values from an array into a ring buffer.  Does not wait.
+ *
+ * @details Faster than calling ring_put n times because the other cog's 
+ * index is only checked once.
+ *
+ * @param *r Address of the ring_t variable.
+ * @param *values Array with values to put.
+ * @param n Number of values in the array.
+ *
+ * @returns Number of values put, which is less than n if the buffer filled up.
+ */
+int ring_putBatch(ring_t *r, const int *values, int n);
+
+/**
+ * @brief Get up to n of the oldest values from a ring buffer.  Does not wait.
+ *
+ * @param *r Address of the ring_t variable.
+ * @param *values Array to receive the values.
+ * @param n Number of elements in the array.
+ *
+ * @returns Number of values received.
+ */
+int ring_getBatch(ring_t *r, int *values, int n);
+
+/**
+ * @brief Find out how many values are waiting in a ring buffer.
+ *
+ * @param *r Address of the ring_t variable.
+ *
+ * @returns Number of values that ring_get can receive.
+ */
+int ring_count(ring_t *r);
+
+/**
+ * @brief Find out how many more values a ring buffer can hold.
+ *
+ * @param *r Address of the ring_t variable.
+ *
+ * @returns Number of values that ring_put can put.
+ */
+int ring_space(ring_t *r);
+
+/**
+ * @brief One request in a cog mailbox.
+ */
+typedef struct mailbox_slot_st
+{
+  volatile unsigned int request;              // Command word or address
+  volatile int time;                          // CNT when posted, then latency
+} mailbox_slot_t;
+
+/**
+ * @brief Cog mailbox.  Declare with MAILBOX, or use mailbox_init.
+ */
+typedef struct mailbox_st
+{
+  volatile unsigned int head;                 // Requests posted, caller only
+  volatile unsigned int tail;                 // Requests finished, driver only
+  unsigned int mask;                          // Slots - 1
+  mailbox_slot_t *slot;                       // Request slots
+  int backoff;                                // Longest waitcnt, 0 to spin
+  unsigned int counted;                       // Latencies added up
+  int fullWaits;                              // Posts that found it full
+  int latencyLast;                            // Ticks from post to finish
+  int latencyAvg;
+  int latencyMax;
+} mailbox_t;
+
+/**
+ * @brief Declare a cog mailbox that can hold a certain number of requests.
+ * Use at file level (outside any function), for example MAILBOX(leds, 4).
+ *
+ * @details Drivers that run in another cog usually take commands through a
+ * single hub variable, so the calling cog has to wait for the driver to
+ * finish (or at least pick up) each command before it can give it the next
+ * one.  A mailbox holds several requests, so the calling cog can post a
+ * batch and get on with its work while the driver catches up.  Each post
+ * returns an ID for checking whether that request is finished, and the
+ * mailbox keeps track of how long requests take from post to finish.
+ *
+ * A request is a 32-bit value, either a packed command or the address of a
+ * structure with the details.  Only one cog should post, and only one cog
+ * (the driver) should receive.
+ *
+ * PASM drivers get the mailbox address in PAR.  head is the long at PAR,
+ * tail at PAR + 4, and the slots are pairs of longs (request, time).  Keep
+ * a count of finished requests, wait for head to differ from it, and read
+ * the request from slot (count & mask).  When done, write CNT - time over
+ * the slot's time, add 1 to the count and write it to tail.  The ws2812
+ * driver is an example.
+ *
+ * @param name Name for the mailbox_t variable.
+ * @param depth Number of requests it can hold, a power of 2.
+ */
+#define MAILBOX(name, depth) \
+  static mailbox_slot_t name##_slots[depth]; \
+  mailbox_t name = {0, 0, (depth) - 1, name##_slots};
+
+/**
+ * @brief Set up a cog mailbox.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ * @param *slots Array of depth slots.
+ * @param depth Number of requests it can hold, a power of 2.
+ */
+void mailbox_init(mailbox_t *mb, mailbox_slot_t *slots, int depth);
+
+/**
+ * @brief Make cogs waiting on a mailbox check it less often, to save hub
+ * access and power.  The first wait is 10 us, and each one after that is
+ * twice as long, up to the maximum.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ * @param ticks Longest wait between checks, in system clock ticks.
+ * Anything below 800 (the default is 0) means check continuously.
+ */
+void mailbox_backoff(mailbox_t *mb, int ticks);
+
+/**
+ * @brief Post a request to a mailbox.  Waits only if the mailbox is full.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ * @param request Command word or address for the driver.
+ *
+ * @returns ID for mailbox_done and mailbox_wait.
+ */
+unsigned int mailbox_post(mailbox_t *mb, unsigned int request);
+
+/**
+ * @brief Check whether a request is finished.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ * @param id ID from mailbox_post.
+ *
+ * @returns 1 if the driver has finished the request, 0 if not.
+ */
+int mailbox_done(mailbox_t *mb, unsigned int id);
+
+/**
+ * @brief Wait for the driver to finish a request.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ * @param id ID from mailbox_post.
+ */
+void mailbox_wait(mailbox_t *mb, unsigned int id);
+
+/**
+ * @brief Wait for the driver to finish every request posted so far.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ */
+void mailbox_sync(mailbox_t *mb);
+
+/**
+ * @brief Find out how many requests are posted but not yet finished.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ *
+ * @returns Number of requests.
+ */
+int mailbox_pending(mailbox_t *mb);
+
+/**
+ * @brief For driver cogs written in C: wait for the next request.  Call
+ * mailbox_finish when done with it.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ *
+ * @returns The request.
+ */
+unsigned int mailbox_receive(mailbox_t *mb);
+
+/**
+ * @brief For driver cogs written in C: mark the request from
+ * mailbox_receive finished.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ */
+void mailbox_finish(mailbox_t *mb);
+
+/**
+ * @brief Display the number of requests finished and pending, how many
+ * posts found the mailbox full, and the last, average and longest time in
+ * system clock ticks from post to finish.
+ *
+ * @details If posts often find the mailbox full, a bigger one lets the
+ * calling cog get further ahead.  Call from the cog that posts.
+ *
+ * @param *mb Address of the mailbox_t variable.
+ * @param *name Name to display.
+ */
+void mailbox_stats(mailbox_t *mb, const char *name);
+
+
 
 /**
  * @}
@@ -0,0 +1,114 @@
+/*
+ * @file cogImage.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Source code for keeping PASM driver images in EEPROM.
+ *
+ * @detail Each stored image's hub RAM becomes a one-block memory pool, so
+ * mem_get can hand it out like any other block.  Loading the image again
+ * takes a block big enough to hold it, usually that same one, for as long
+ * as the cog needs to copy it.
+ */
+
+#include "simpletools.h"
+
+#define COG_LOAD_TICKS 8400                   // 496 longs, 16 ticks each
+
+typedef struct
+{
+  const void *image;                          // Linked image address
+  int eeAddr;                                 // Copy in EEPROM
+  int bytes;
+  mem_pool_t pool;                            // Image's reclaimed hub RAM
+} cog_image_t;
+
+static cog_image_t cogImages[COG_IMAGE_MAX];
+static int cogImageCount;
+
+static cog_image_t *cog_imageFind(const void *image)
+{
+  int i;
+  for(i = 0; i < cogImageCount; i++)
+  {
+    if(cogImages[i].image == image) return &cogImages[i];
+  }
+  return 0;
+}
+
+int cog_imageStore(const void *image, int bytes, int eeAddr)
+{
+  unsigned char buf[32];
+  const unsigned char *src = image;
+  int i, n;
+  if(bytes <= 0 || cog_imageFind(image) || cogImageCount == COG_IMAGE_MAX)
+    return 0;
+
+  for(i = 0; i < bytes; i += n)               // Only write EEPROM if the
+  {                                           // copy there is different
+    n = bytes - i < (int) sizeof(buf) ? bytes - i : (int) sizeof(buf);
+    ee_getStr(buf, n, eeAddr + i);
+    if(memcmp(buf, src + i, n)) break;
+  }
+  if(i < bytes) ee_putStr((unsigned char *) src, bytes, eeAddr);
+
+  cog_image_t *ci = &cogImages[cogImageCount++];
+  ci->image = image;
+  ci->eeAddr = eeAddr;
+  ci->bytes = bytes;
+#if defined(__PROPELLER_USE_XMM__)
+  return 0;                                   // Image is not in hub RAM
+#else
+  ci->pool.name = "cog image";
+  ci->pool.blockSize = bytes & ~3;            // Only the image's own RAM
+  ci->pool.blocks = 1;
+  ci->pool.storage = (void *) image;
+  mem_poolAdd(&ci->pool);
+  return ci->pool.blockSize;
+#endif
+}
+
+void *cog_imageLoad(const void *image)
+{
+  cog_image_t *ci = cog_imageFind(image);
+  void *code;
+  if(!ci) return (void *) image;
+  code = mem_get((ci->bytes + 3) & ~3);       // Cogs load whole longs
+  if(code) ee_getStr(code, ci->bytes, ci->eeAddr);
+  return code;
+}
+
+int cog_imageStart(const void *image, void *code, void *par)
+{
+  int id;
+  if(!code) return -1;
+  id = cognew(code, par);
+  if(id >= 0) waitcnt(CNT + COG_LOAD_TICKS);
+  if(code != image) mem_put(code);
+  return id;
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -15,20 +15,21 @@
 void cog_end(int *coginfo)
 {
   int cog = *coginfo - 1;
+  *coginfo = 0;                               // Before mem_put links the block
   if(cog > -1)
   {
+    if(st_stackRemove) st_stackRemove(coginfo + 1);
     if(cog == cogid())
     {
-      free(coginfo); 
+      mem_put(coginfo); 
       cogstop(cog);
     }
     else
     {
       cogstop(cog);
-      free(coginfo); 
+      mem_put(coginfo); 
     }    
   }    
-  *coginfo = 0;
 }
 
 
@@ -12,14 +12,19 @@
 
 #include "simpletools.h"
 
+int (*st_stackAdd)(const char *name, void *stack, int stacksize);
+void (*st_stackRemove)(void *stack);
+
 int *cog_run(void (*function)(void *par), int stacksize)
 {
   int *addr;
-  addr = malloc(stacksize += 4 + 176 + (stacksize * 4));
-  *addr = 1 + cogstart(function, NULL, addr + 4, stacksize - 4);
+  addr = mem_get(stacksize += 4 + 176 + (stacksize * 4));
+  if(st_stackAdd) st_stackAdd("cog_run", addr + 1, stacksize - 4);
+  *addr = 1 + cogstart(function, NULL, addr + 1, stacksize - 4);
   if(*addr == 0)
   {
-    free(addr);
+    if(st_stackRemove) st_stackRemove(addr + 1);
+    mem_put(addr);
     return (int*) 0;
   }
   return addr;  
@@ -38,8 +38,11 @@ void dac_ctr(int pin, int channel, int dacVal)
   if(dacCtrBits == 0) dacCtrBits = 8;
   int dacBitX = 32 - dacCtrBits;
   
-  if(!cog) cog = cogstart(dac_ctr_cog, NULL,
-                          stack, sizeof(stack)) + 1;
+  if(!cog)
+  {
+    if(st_stackAdd) st_stackAdd("dac_ctr", stack, sizeof(stack));
+    cog = cogstart(dac_ctr_cog, NULL, stack, sizeof(stack)) + 1;
+  }
   if(!channel)
   {
     ctra = (DUTY_SE + pin);
@@ -0,0 +1,140 @@
+/*
+ * @file mailbox.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Source code for cog mailbox functions.
+ *
+ * @detail Like a ring buffer, only the calling cog writes head and only the
+ * driver cog writes tail, so neither needs a lock.  head and tail count
+ * requests instead of indexing slots, so head - tail is the number
+ * outstanding, with no slot left empty, and a request's ID is just the
+ * value of head after posting it.  The driver turns each slot's post time
+ * into a latency when it finishes, and the calling cog adds the latencies up
+ * later, so the driver only spends a couple of instructions on statistics.
+ */
+
+#include "simpletools.h"
+
+#define MAILBOX_MIN_WAIT 800                  // Shortest safe waitcnt in XMMC
+
+static int mailbox_pause(mailbox_t *mb, int ticks)
+{
+  if(mb->backoff < MAILBOX_MIN_WAIT) return 0;
+  if(ticks < MAILBOX_MIN_WAIT) ticks = MAILBOX_MIN_WAIT;
+  waitcnt(CNT + ticks);
+  ticks <<= 1;
+  return ticks < mb->backoff ? ticks : mb->backoff;
+}
+
+static void mailbox_count(mailbox_t *mb)
+{
+  unsigned int tail = mb->tail;
+  while(mb->counted != tail)
+  {
+    int t = mb->slot[mb->counted & mb->mask].time;
+    mb->latencyLast = t;
+    if(t > mb->latencyMax) mb->latencyMax = t;
+    if(mb->counted++) mb->latencyAvg += (t - mb->latencyAvg) / 8;
+    else mb->latencyAvg = t;
+  }
+}
+
+void mailbox_init(mailbox_t *mb, mailbox_slot_t *slots, int depth)
+{
+  memset(mb, 0, sizeof(mailbox_t));
+  mb->mask = depth - 1;
+  mb->slot = slots;
+}
+
+void mailbox_backoff(mailbox_t *mb, int ticks)
+{
+  mb->backoff = ticks;
+}
+
+unsigned int mailbox_post(mailbox_t *mb, unsigned int request)
+{
+  unsigned int id = mb->head;
+  int ticks = 0;
+  if(id - mb->tail > mb->mask)
+  {
+    mb->fullWaits++;
+    while(id - mb->tail > mb->mask) ticks = mailbox_pause(mb, ticks);
+  }
+  mailbox_count(mb);
+  mailbox_slot_t *s = &mb->slot[id & mb->mask];
+  s->request = request;
+  s->time = CNT;
+  mb->head = ++id;
+  return id;
+}
+
+int mailbox_done(mailbox_t *mb, unsigned int id)
+{
+  mailbox_count(mb);
+  return (int) (mb->tail - id) >= 0;
+}
+
+void mailbox_wait(mailbox_t *mb, unsigned int id)
+{
+  int ticks = 0;
+  while((int) (mb->tail - id) < 0) ticks = mailbox_pause(mb, ticks);
+  mailbox_count(mb);
+}
+
+void mailbox_sync(mailbox_t *mb)
+{
+  mailbox_wait(mb, mb->head);
+}
+
+int mailbox_pending(mailbox_t *mb)
+{
+  return mb->head - mb->tail;
+}
+
+unsigned int mailbox_receive(mailbox_t *mb)
+{
+  int ticks = 0;
+  while(mb->head == mb->tail) ticks = mailbox_pause(mb, ticks);
+  return mb->slot[mb->tail & mb->mask].request;
+}
+
+void mailbox_finish(mailbox_t *mb)
+{
+  mailbox_slot_t *s = &mb->slot[mb->tail & mb->mask];
+  s->time = CNT - s->time;
+  mb->tail++;
+}
+
+void mailbox_stats(mailbox_t *mb, const char *name)
+{
+  mailbox_count(mb);
+  print("%s: requests %d, pending %d, full %d, latency last %d, avg %d, "
+        "max %d\n", name, mb->counted, mailbox_pending(mb), mb->fullWaits,
+        mb->latencyLast, mb->latencyAvg, mb->latencyMax);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
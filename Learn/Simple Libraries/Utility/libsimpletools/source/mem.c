@@ -0,0 +1,138 @@
+/*
+ * @file mem.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Source code for fixed-block memory pool functions.
+ *
+ * @detail Free blocks are kept in a singly linked list threaded through 
+ * their first long, so allocating and freeing are both a couple of pointer
+ * moves.  Blocks that have never been used are handed out in order from the
+ * pool's storage, so a pool needs no set up code before its first block is 
+ * allocated.  A lock, taken when the first pool is added, keeps cogs that
+ * get and put blocks at the same time (cog_end from the cog itself, drivers
+ * closed from other cogs) from breaking up the lists.
+ */
+
+#include "simpletools.h"
+
+static mem_pool_t *memPools;
+static int memHeapUsed, memHeapHigh;
+static int memLock = -1;
+
+void mem_poolAdd(mem_pool_t *pool)
+{
+  mem_pool_t **p;
+  if(memLock < 0) memLock = locknew();
+  if(memLock >= 0) while(lockset(memLock));
+  for(p = &memPools; *p && *p != pool; p = &(*p)->next)
+    if((*p)->blockSize > pool->blockSize) break;
+  if(*p != pool)
+  {
+    pool->next = *p;
+    *p = pool;
+  }
+  if(memLock >= 0) lockclr(memLock);
+}
+
+void *mem_alloc(mem_pool_t *pool)
+{
+  void **block;
+  if(memLock >= 0) while(lockset(memLock));
+  block = pool->freeList;
+  if(block)
+  {
+    pool->freeList = *block;
+  }
+  else if(pool->fresh < pool->blocks)
+  {
+    block = (void **) ((char *) pool->storage + pool->fresh * pool->blockSize);
+    pool->fresh++;
+  }
+  if(block && ++pool->used > pool->highWater) pool->highWater = pool->used;
+  if(memLock >= 0) lockclr(memLock);
+  return block;
+}
+
+void mem_free(mem_pool_t *pool, void *ptr)
+{
+  void **block = ptr;
+  if(memLock >= 0) while(lockset(memLock));
+  *block = pool->freeList;
+  pool->freeList = block;
+  pool->used--;
+  if(memLock >= 0) lockclr(memLock);
+}
+
+void *mem_get(int size)
+{
+  mem_pool_t *pool;
+  void *ptr;
+  for(pool = memPools; pool; pool = pool->next)
+  {
+    if(pool->blockSize < size) continue;
+    if((ptr = mem_alloc(pool)) != 0) return ptr;
+  }
+  if((ptr = malloc(size)) != 0)
+  {
+    if(memLock >= 0) while(lockset(memLock));
+    if(++memHeapUsed > memHeapHigh) memHeapHigh = memHeapUsed;
+    if(memLock >= 0) lockclr(memLock);
+  }
+  return ptr;
+}
+
+void mem_put(void *ptr)
+{
+  mem_pool_t *pool;
+  if(!ptr) return;
+  for(pool = memPools; pool; pool = pool->next)
+  {
+    char *start = (char *) pool->storage;
+    if((char *) ptr >= start && (char *) ptr < start + pool->blocks * pool->blockSize)
+    {
+      mem_free(pool, ptr);
+      return;
+    }
+  }
+  free(ptr);
+  if(memLock >= 0) while(lockset(memLock));
+  memHeapUsed--;
+  if(memLock >= 0) lockclr(memLock);
+}
+
+void mem_stats(void)
+{
+  mem_pool_t *pool;
+  for(pool = memPools; pool; pool = pool->next)
+  {
+    print("%s: size %d, blocks %d, used %d, high %d\n", pool->name, 
+          pool->blockSize, pool->blocks, pool->used, pool->highWater);
+  }
+  print("heap: used %d, high %d\n", memHeapUsed, memHeapHigh);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
\ No newline at end of file
@@ -0,0 +1,181 @@
+/*
+ * @file pinEvents.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright Copyright (C) Parallax, Inc. 2014.  See end of file for
+ * terms of use (MIT License).
+ *
+ * @brief pin_events function source, see simpletools.h for documentation.
+ *
+ * @detail A cog waits for any subscribed pin to change with waitpne,
+ * timestamps the edge with CNT, and puts an event in the queue of each
+ * subscriber watching that pin.  Each queue has one producer (the event
+ * cog) and one consumer, so like ring_t, only the event cog moves head and
+ * only the subscriber moves tail, and one element is left empty so that
+ * head == tail always means empty.  Subscribing or unsubscribing restarts
+ * the cog with the new set of pins.
+ *
+ * Please submit bug reports, suggestions, and improvements to
+ * this code to editor@parallax.com.
+ */
+
+#include "simpletools.h"
+
+#define PIN_EVENTS_MIN_WAIT 800               // Shortest safe waitcnt in XMMC
+
+void pin_events_cog(void *par);
+static unsigned int pestack[(160 + (50 * 4)) / 4];
+
+static pin_events_t *peSubs;
+static int pecog = 0;
+
+static int pin_events_pause(pin_events_t *sub, int ticks)
+{
+  if(sub->backoff < PIN_EVENTS_MIN_WAIT) return 0;
+  if(ticks < PIN_EVENTS_MIN_WAIT) ticks = PIN_EVENTS_MIN_WAIT;
+  waitcnt(CNT + ticks);
+  ticks <<= 1;
+  return ticks < sub->backoff ? ticks : sub->backoff;
+}
+
+static void pin_events_restart(void)
+{
+  unsigned int mask = 0;
+  pin_events_t *s;
+  pin_events_stop();
+  for(s = peSubs; s; s = s->next) mask |= s->mask;
+  if(!mask) return;
+  if(st_stackAdd) st_stackAdd("pin_events", pestack, sizeof(pestack));
+  pecog = cogstart(pin_events_cog, (void *) mask, pestack, sizeof(pestack)) + 1;
+}
+
+int pin_events_subscribe(pin_events_t *sub, unsigned int pinMask,
+                         pin_event_t *buf, int size)
+{
+  pin_events_unsubscribe(sub);
+  sub->mask = pinMask;
+  sub->head = 0;
+  sub->tail = 0;
+  sub->size = size;
+  sub->buf = buf;
+  sub->dropped = 0;
+  sub->backoff = CLKFREQ / 10000;
+  sub->next = peSubs;
+  peSubs = sub;
+  pin_events_restart();
+  return pecog;
+}
+
+void pin_events_unsubscribe(pin_events_t *sub)
+{
+  pin_events_t **p;
+  for(p = &peSubs; *p; p = &(*p)->next)
+  {
+    if(*p != sub) continue;
+    *p = sub->next;
+    pin_events_restart();
+    return;
+  }
+}
+
+int pin_events_count(pin_events_t *sub)
+{
+  int n = sub->head - sub->tail;
+  if(n < 0) n += sub->size;
+  return n;
+}
+
+int pin_events_get(pin_events_t *sub, pin_event_t *event)
+{
+  int tail = sub->tail;
+  if(tail == sub->head) return 0;
+  *event = sub->buf[tail];
+  if(++tail == sub->size) tail = 0;
+  sub->tail = tail;
+  return 1;
+}
+
+int pin_events_getBatch(pin_events_t *sub, pin_event_t *events, int n)
+{
+  int tail = sub->tail, head = sub->head, got = 0;
+  while(got < n && tail != head)
+  {
+    events[got++] = sub->buf[tail];
+    if(++tail == sub->size) tail = 0;
+  }
+  sub->tail = tail;
+  return got;
+}
+
+void pin_events_backoff(pin_events_t *sub, int ticks)
+{
+  sub->backoff = ticks;
+}
+
+void pin_events_wait(pin_events_t *sub, pin_event_t *event)
+{
+  int ticks = 0;
+  while(!pin_events_get(sub, event)) ticks = pin_events_pause(sub, ticks);
+}
+
+void pin_events_stop(void)
+{
+  if(pecog) cogstop(pecog - 1);
+  pecog = 0;
+}
+
+void pin_events_cog(void *par)
+{
+  unsigned int mask = (unsigned int) par;
+  unsigned int state = INA & mask;
+  while(1)
+  {
+    waitpne(state, mask);
+    unsigned int t = CNT;
+    unsigned int now = INA & mask;
+    unsigned int changed = now ^ state;
+    state = now;
+    for(pin_events_t *s = peSubs; s; s = s->next)
+    {
+      int pin = 0;
+      for(unsigned int bits = changed & s->mask; bits; bits >>= 1, pin++)
+      {
+        if(!(bits & 1)) continue;
+        int head = s->head, next = head + 1;
+        if(next == s->size) next = 0;
+        if(next == s->tail)
+        {
+          s->dropped++;
+          continue;
+        }
+        s->buf[head].time = t;
+        s->buf[head].pin = pin;
+        s->buf[head].edge = (now >> pin) & 1;
+        s->head = next;
+      }
+    }
+  }
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,147 @@
+/*
+ * @file pool.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Source code for worker cog pool functions.
+ *
+ * @detail Jobs go into a circular table of POOL_JOBS slots in the order 
+ * they are submitted.  A Propeller lock makes submitting and taking jobs 
+ * one-at-a-time operations.  Each slot has a sequence number that goes up 
+ * every time the slot is reused, and a job's handle includes it, so 
+ * pool_wait can tell a finished job from a newer job in the same slot.
+ */
+
+#include "simpletools.h"
+
+#define POOL_FREE    0
+#define POOL_QUEUED  1
+#define POOL_RUNNING 2
+
+typedef struct pool_job_s
+{
+  void (*function)(void *par);
+  void *par;
+  volatile int state;
+  volatile int seq;
+} pool_job_t;
+
+static pool_job_t poolJob[POOL_JOBS];
+static volatile int poolHead, poolTail, poolLock = -1;
+static int *poolCog[8];
+static int poolCogs, poolStack = POOL_STACK;
+
+static void pool_worker(void *par);
+
+void pool_stack(int stacksize)
+{
+  poolStack = stacksize;
+}
+
+int pool_start(int nCogs)
+{
+  pool_stop();
+  poolLock = locknew();
+  if(poolLock < 0) return 0;
+  poolHead = poolTail = 0;
+  for(int i = 0; i < POOL_JOBS; i++) poolJob[i].state = POOL_FREE;
+  if(nCogs > 8) nCogs = 8;
+  for(poolCogs = 0; poolCogs < nCogs; poolCogs++)
+  {
+    poolCog[poolCogs] = cog_run(pool_worker, poolStack);
+    if(!poolCog[poolCogs]) break;
+  }
+  return poolCogs;
+}
+
+int pool_submit(void (*function)(void *par), void *par)
+{
+  if(!poolCogs) return -1;
+  while(1)
+  {
+    while(lockset(poolLock));
+    int i = poolTail;
+    pool_job_t *job = &poolJob[i];
+    if(job->state == POOL_FREE)
+    {
+      job->function = function;
+      job->par = par;
+      job->seq++;
+      job->state = POOL_QUEUED;
+      if(++poolTail == POOL_JOBS) poolTail = 0;
+      int handle = (job->seq & 0xFFFF) * POOL_JOBS + i;
+      lockclr(poolLock);
+      return handle;
+    }
+    lockclr(poolLock);                        // Table full, let a job finish
+  }
+}
+
+int pool_done(int handle)
+{
+  if(handle < 0) return 1;
+  pool_job_t *job = &poolJob[handle % POOL_JOBS];
+  return (job->seq & 0xFFFF) != handle / POOL_JOBS || job->state == POOL_FREE;
+}
+
+void pool_wait(int handle)
+{
+  while(!pool_done(handle));
+}
+
+void pool_stop(void)
+{
+  while(poolCogs) cog_end(poolCog[--poolCogs]);
+  if(poolLock >= 0) lockret(poolLock);
+  poolLock = -1;
+}
+
+static void pool_worker(void *par)
+{
+  while(1)
+  {
+    pool_job_t *job = 0;
+    while(lockset(poolLock));
+    if(poolJob[poolHead].state == POOL_QUEUED)
+    {
+      job = &poolJob[poolHead];
+      job->state = POOL_RUNNING;
+      if(++poolHead == POOL_JOBS) poolHead = 0;
+    }
+    lockclr(poolLock);
+    if(job)
+    {
+      job->function(job->par);
+      job->state = POOL_FREE;
+    }
+    else
+    {
+      waitcnt(CNT + st_usTicks * 10);         // Idle, stay off the lock
+    }
+  }
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
\ No newline at end of file
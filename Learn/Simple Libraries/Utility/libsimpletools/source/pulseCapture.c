@@ -0,0 +1,126 @@
+/*
+ * @file pulseCapture.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright Copyright (C) Parallax, Inc. 2014.  See end of file for
+ * terms of use (MIT License).
+ *
+ * @brief pulse_capture function source, see simpletools.h for documentation.
+ *
+ * @detail A cog waits for any pin in the mask to change with waitpne, 
+ * timestamps the edge with CNT, and stores the most recent high and low 
+ * widths along with an edge count for each pin.  Each table entry is a 
+ * single long, so readers in other cogs never see a partially written 
+ * value.
+ *
+ * Please submit bug reports, suggestions, and improvements to
+ * this code to editor@parallax.com.
+ */
+
+#include "simpletools.h"
+
+void pulse_capture_cog(void *par);
+static unsigned int pcstack[(160 + (50 * 4)) / 4];
+
+static volatile unsigned int pcMask;
+static volatile unsigned int pcHigh[32], pcLow[32], pcEdges[32];
+
+// Edge times, only touched by the capture cog.
+static unsigned int pcRise[32], pcFall[32];
+
+static int pccog = 0;
+
+int pulse_capture_start(unsigned int pinMask)
+{
+  pulse_capture_stop();
+  for(int i = 0; i < 32; i++)
+  {
+    pcHigh[i] = 0;
+    pcLow[i] = 0;
+    pcEdges[i] = 0;
+  }
+  pcMask = pinMask;
+  if(st_stackAdd) st_stackAdd("pulse_capture", pcstack, sizeof(pcstack));
+  pccog = cogstart(pulse_capture_cog, NULL, pcstack, sizeof(pcstack)) + 1;
+  return pccog;
+}
+
+long pulse_capture_high(int pin)
+{
+  return pcHigh[pin & 31] / st_iodt;
+}
+
+long pulse_capture_low(int pin)
+{
+  return pcLow[pin & 31] / st_iodt;
+}
+
+unsigned int pulse_capture_edges(int pin)
+{
+  return pcEdges[pin & 31];
+}
+
+void pulse_capture_stop(void)
+{
+  if(pccog) cogstop(pccog - 1);
+  pccog = 0;
+}
+
+void pulse_capture_cog(void *par)
+{
+  unsigned int mask = pcMask;
+  unsigned int state = INA & mask;
+  unsigned int t = CNT;
+  for(int i = 0; i < 32; i++)
+  {
+    pcRise[i] = t;
+    pcFall[i] = t;
+  }
+  while(1)
+  {
+    waitpne(state, mask);
+    t = CNT;
+    unsigned int now = INA & mask;
+    unsigned int changed = now ^ state;
+    state = now;
+    int pin = 0;
+    for(unsigned int bits = changed; bits; bits >>= 1, pin++)
+    {
+      if(!(bits & 1)) continue;
+      if(now & (1 << pin))
+      {
+        if(pcEdges[pin]) pcLow[pin] = t - pcFall[pin];
+        pcRise[pin] = t;
+      }
+      else
+      {
+        if(pcEdges[pin]) pcHigh[pin] = t - pcRise[pin];
+        pcFall[pin] = t;
+      }
+      pcEdges[pin]++;
+    }
+  }
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -34,7 +34,9 @@ static int pwcog = 0;
 int pwm_start(unsigned int cycleMicroseconds)
 {
   //us = CLKFREQ/1000000;
+  pwm_stop();                                 // Not while a cog uses it
   tCycle = cycleMicroseconds * st_usTicks;
+  if(st_stackAdd) st_stackAdd("pwm", pwstack, sizeof(pwstack));
   pwcog = cogstart(pw, NULL, pwstack, sizeof(pwstack)) + 1;  
   return pwcog;
 }
@@ -0,0 +1,252 @@
+/*
+ * @file pwmMulti.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright Copyright (C) Parallax, Inc. 2014.  See end of file for
+ * terms of use (MIT License).
+ *
+ * @brief pwm_multi function source, see simpletools.h for documentation.
+ *
+ * @detail pwm_multi_commit converts each group's high times into a 
+ * schedule of (offset, pin mask) falling edges sorted by offset and writes it 
+ * to the back half of a double buffer.  The PWM cog plays the front half: at 
+ * the start of a group's period it raises the group's pins, then clears them 
+ * with one waitcnt per distinct edge time.  A group only switches to the new 
+ * schedule at the start of its period, so every cycle is either all old or 
+ * all new values.
+ *
+ * Please submit bug reports, suggestions, and improvements to
+ * this code to editor@parallax.com.
+ */
+
+#include "simpletools.h"
+
+typedef struct pwm_sched_s
+{
+  unsigned int tCycle;                        // Period ticks, 0 = group off
+  unsigned int pins;                          // All pins in the group
+  unsigned int high;                          // Pins that go high at start
+  int edges;                                  // Number of falling edges
+  unsigned int t[32];                         // Edge offsets, ascending
+  unsigned int m[32];                         // Pins that go low at t[i]
+} pwm_sched_t;
+
+void pwm_multi_cog(void *par);
+static unsigned int pmstack[(160 + (60 * 4)) / 4];
+
+static pwm_sched_t pmSched[2][PWM_MULTI_GROUPS];
+static volatile int pmFront[PWM_MULTI_GROUPS];
+static volatile unsigned int pmSwap, pmLate;
+static int pmcog = 0;
+
+// Settings only touched by the calling cog.
+static unsigned int pmCycle[PWM_MULTI_GROUPS];
+static signed char pmGroup[32] = {-1, -1, -1, -1, -1, -1, -1, -1, 
+                                  -1, -1, -1, -1, -1, -1, -1, -1, 
+                                  -1, -1, -1, -1, -1, -1, -1, -1, 
+                                  -1, -1, -1, -1, -1, -1, -1, -1}; 
+static int pmRes[32], pmLevel[32];
+
+int pwm_multi_start(void)
+{
+  pwm_multi_stop();
+  pmLate = 0;
+  memset(pmSched, 0, sizeof(pmSched));        // No schedule until a commit
+  for(int g = 0; g < PWM_MULTI_GROUPS; g++) pmFront[g] = 0;
+  if(st_stackAdd) st_stackAdd("pwm_multi", pmstack, sizeof(pmstack));
+  pmcog = cogstart(pwm_multi_cog, NULL, pmstack, sizeof(pmstack)) + 1;
+  return pmcog;
+}
+
+void pwm_multi_group(int group, unsigned int cycleMicroseconds)
+{
+  if(group < 0 || group >= PWM_MULTI_GROUPS) return;
+  pmCycle[group] = cycleMicroseconds * st_usTicks;
+}
+
+void pwm_multi_pin(int pin, int group, int resolution)
+{
+  pin &= 31;
+  if(group >= PWM_MULTI_GROUPS) group = -1;
+  if(resolution < 1) resolution = 1;
+  if(resolution > 65535) resolution = 65535;
+  pmGroup[pin] = group;
+  pmRes[pin] = resolution;
+  pmLevel[pin] = 0;
+}
+
+void pwm_multi_set(int pin, int level)
+{
+  pin &= 31;
+  if(level < 0) level = 0;
+  if(level > pmRes[pin]) level = pmRes[pin];
+  pmLevel[pin] = level;
+}
+
+void pwm_multi_commit(void)
+{
+  while(pmcog && pmSwap);                     // Previous commit not taken yet
+  unsigned int swap = 0;
+  for(int g = 0; g < PWM_MULTI_GROUPS; g++)
+  {
+    pwm_sched_t *s = &pmSched[pmFront[g] ^ 1][g];
+    unsigned int cycle = pmCycle[g];
+    s->tCycle = cycle;
+    s->pins = 0;
+    s->high = 0;
+    s->edges = 0;
+    for(int pin = 0; pin < 32; pin++)
+    {
+      if(pmGroup[pin] != g) continue;
+      unsigned int mask = 1 << pin;
+      s->pins |= mask;
+      int res = pmRes[pin];
+      unsigned int level = pmLevel[pin];
+      if(!level || !cycle) continue;
+      s->high |= mask;
+      unsigned int tHigh = (cycle / res) * level + ((cycle % res) * level) / res;
+      if(tHigh >= cycle) continue;            // Full on, no falling edge
+      // Insert in order, sharing an entry with pins that fall at the same time
+      int i = s->edges;
+      while(i > 0 && s->t[i - 1] > tHigh) i--;
+      if(i > 0 && s->t[i - 1] == tHigh)
+      {
+        s->m[i - 1] |= mask;
+        continue;
+      }
+      for(int j = s->edges; j > i; j--)
+      {
+        s->t[j] = s->t[j - 1];
+        s->m[j] = s->m[j - 1];
+      }
+      s->t[i] = tHigh;
+      s->m[i] = mask;
+      s->edges++;
+    }
+    if(s->tCycle || pmSched[pmFront[g]][g].tCycle) swap |= 1 << g;
+  }
+  pmSwap = swap;
+}
+
+unsigned int pwm_multi_jitter(void)
+{
+  return pmLate;
+}
+
+void pwm_multi_stop(void)
+{
+  if(pmcog) cogstop(pmcog - 1);
+  pmcog = 0;
+  pmSwap = 0;
+}
+
+void pwm_multi_cog(void *par)
+{
+  pwm_sched_t *cur[PWM_MULTI_GROUPS];
+  unsigned int start[PWM_MULTI_GROUPS], next[PWM_MULTI_GROUPS];
+  int idx[PWM_MULTI_GROUPS];
+  unsigned int t = CNT;
+  int g;
+  for(g = 0; g < PWM_MULTI_GROUPS; g++)
+  {
+    cur[g] = &pmSched[pmFront[g]][g];
+    idx[g] = -1;
+    next[g] = t;
+    start[g] = t;
+  }
+  while(1)
+  {
+    // Groups that are off start as soon as a schedule arrives.
+    int active = -1;
+    int soonest = 0;
+    t = CNT;
+    for(g = 0; g < PWM_MULTI_GROUPS; g++)
+    {
+      if(!cur[g]->tCycle)
+      {
+        if(!(pmSwap & (1 << g))) continue;
+        pmFront[g] ^= 1;
+        cur[g] = &pmSched[pmFront[g]][g];
+        pmSwap &= ~(1 << g);
+        if(!cur[g]->tCycle) continue;
+        DIRA |= cur[g]->pins;
+        idx[g] = -1;
+        next[g] = start[g] = t + st_usTicks * 20;
+      }
+      if(active < 0 || (int)(next[g] - t) < soonest)
+      {
+        active = g;
+        soonest = next[g] - t;
+      }
+    }
+    if(active < 0)
+    {
+      waitcnt(t + st_usTicks * 100);
+      continue;
+    }
+
+    g = active;
+    if((int)(next[g] - CNT) > 0)
+      waitcnt(next[g]);
+    else if(CNT - next[g] > pmLate)
+      pmLate = CNT - next[g];
+
+    pwm_sched_t *s = cur[g];
+    if(idx[g] < 0)
+    {
+      if(pmSwap & (1 << g))
+      {
+        pmFront[g] ^= 1;
+        cur[g] = &pmSched[pmFront[g]][g];
+        pmSwap &= ~(1 << g);
+        unsigned int release = s->pins;
+        for(int i = 0; i < PWM_MULTI_GROUPS; i++)
+          if(i != g && cur[i]->tCycle) release &= ~cur[i]->pins;
+        OUTA &= ~release;
+        DIRA &= ~release;
+        s = cur[g];
+        if(!s->tCycle) continue;
+        DIRA |= s->pins;
+      }
+      OUTA = (OUTA & ~s->pins) | s->high;
+      idx[g] = 0;
+    }
+    else
+    {
+      OUTA &= ~s->m[idx[g]++];
+    }
+    if(idx[g] < s->edges)
+    {
+      next[g] = start[g] + s->t[idx[g]];
+    }
+    else
+    {
+      start[g] += s->tCycle;
+      next[g] = start[g];
+      idx[g] = -1;
+    }
+  }
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
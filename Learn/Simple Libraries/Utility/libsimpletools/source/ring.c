@@ -0,0 +1,121 @@
+/*
+ * @file ring.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright Copyright (C) Parallax, Inc. 2014.  See end of file for
+ * terms of use (MIT License).
+ *
+ * @brief ring buffer function source, see simpletools.h for documentation.
+ *
+ * @detail Only the producer writes head and only the consumer writes tail.
+ * Each is a single long, so one cog never sees the other's index half 
+ * written, and a value is always stored before head moves past it.  One 
+ * element is left empty so that head == tail always means empty.  Multiple
+ * producers take turns with a Propeller lock.
+ *
+ * Please submit bug reports, suggestions, and improvements to
+ * this code to editor@parallax.com.
+ */
+
+#include "simpletools.h"
+
+void ring_init(ring_t *r, int *buf, int size)
+{
+  r->head = 0;
+  r->tail = 0;
+  r->size = size;
+  r->buf = buf;
+  r->lock = -1;
+}
+
+int ring_initMulti(ring_t *r, int *buf, int size)
+{
+  ring_init(r, buf, size);
+  r->lock = locknew();
+  return r->lock;
+}
+
+void ring_close(ring_t *r)
+{
+  if(r->lock >= 0) lockret(r->lock);
+  r->lock = -1;
+}
+
+int ring_count(ring_t *r)
+{
+  int n = r->head - r->tail;
+  if(n < 0) n += r->size;
+  return n;
+}
+
+int ring_space(ring_t *r)
+{
+  return r->size - 1 - ring_count(r);
+}
+
+int ring_putBatch(ring_t *r, const int *values, int n)
+{
+  if(r->lock >= 0) while(lockset(r->lock));
+  int head = r->head;
+  int tail = r->tail;
+  int space = tail - head - 1;
+  if(space < 0) space += r->size;
+  if(n > space) n = space;
+  for(int i = 0; i < n; i++)
+  {
+    r->buf[head] = values[i];
+    if(++head == r->size) head = 0;
+  }
+  r->head = head;
+  if(r->lock >= 0) lockclr(r->lock);
+  return n;
+}
+
+int ring_getBatch(ring_t *r, int *values, int n)
+{
+  int head = r->head;
+  int tail = r->tail;
+  int count = head - tail;
+  if(count < 0) count += r->size;
+  if(n > count) n = count;
+  for(int i = 0; i < n; i++)
+  {
+    values[i] = r->buf[tail];
+    if(++tail == r->size) tail = 0;
+  }
+  r->tail = tail;
+  return n;
+}
+
+int ring_put(ring_t *r, int value)
+{
+  return ring_putBatch(r, &value, 1);
+}
+
+int ring_get(ring_t *r, int *value)
+{
+  return ring_getBatch(r, value, 1);
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
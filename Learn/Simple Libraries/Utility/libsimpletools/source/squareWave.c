@@ -37,8 +37,11 @@ int int_fraction(int a, int b, int shift);
 
 void square_wave(int pin, int channel, int freq)
 {
-  if(!cog)     cog = cogstart(square_wave_cog, NULL,
-                   stack, sizeof(stack)) + 1;
+  if(!cog)
+  {
+    if(st_stackAdd) st_stackAdd("square_wave", stack, sizeof(stack));
+    cog = cogstart(square_wave_cog, NULL, stack, sizeof(stack)) + 1;
+  }
 
   int ctr, frq;
   square_wave_setup(pin, freq, &ctr, &frq);
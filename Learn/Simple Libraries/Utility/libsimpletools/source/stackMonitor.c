@@ -0,0 +1,116 @@
+/*
+ * @file stackMonitor.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Source code for stack_monitor functions.
+ *
+ * @detail Each long in a registered stack is painted with a pattern that
+ * depends on its address before the cog starts.  Stacks grow down from the 
+ * top, so the lowest long that no longer matches its pattern marks the 
+ * deepest the stack has gone.  Checking only reads the stack, so the cog 
+ * keeps running.
+ */
+
+#include "simpletools.h"
+
+#define STACK_PAINT 0x5A17C3E5
+
+typedef struct stack_entry_s
+{
+  const char *name;
+  int *stack;
+  int ints;
+} stack_entry_t;
+
+static stack_entry_t stackEntry[STACK_MONITOR_MAX];
+
+void stack_monitor_start(void)
+{
+  st_stackAdd = stack_monitor_add;
+  st_stackRemove = stack_monitor_remove;
+}
+
+int stack_monitor_add(const char *name, void *stack, int stacksize)
+{
+  int id, free = -1;
+  for(id = 0; id < STACK_MONITOR_MAX; id++)
+  {
+    if(stackEntry[id].stack == stack) break;
+    if(free < 0 && !stackEntry[id].stack) free = id;
+  }
+  if(id == STACK_MONITOR_MAX) id = free;
+  if(id < 0) return -1;
+  stack_entry_t *e = &stackEntry[id];
+  e->name = name;
+  e->stack = (int *) stack;
+  e->ints = stacksize / sizeof(int);
+  for(int i = 0; i < e->ints; i++)
+    e->stack[i] = STACK_PAINT ^ (int) &e->stack[i];
+  return id;
+}
+
+void stack_monitor_remove(void *stack)
+{
+  for(int id = 0; id < STACK_MONITOR_MAX; id++)
+    if(stackEntry[id].stack == stack) stackEntry[id].stack = 0;
+}
+
+const char *stack_monitor_name(int id)
+{
+  if(id < 0 || id >= STACK_MONITOR_MAX || !stackEntry[id].stack) return 0;
+  return stackEntry[id].name;
+}
+
+int stack_monitor_size(int id)
+{
+  if(!stack_monitor_name(id)) return 0;
+  return stackEntry[id].ints;
+}
+
+int stack_monitor_used(int id)
+{
+  if(!stack_monitor_name(id)) return 0;
+  stack_entry_t *e = &stackEntry[id];
+  int i;
+  for(i = 0; i < e->ints; i++)
+    if(e->stack[i] != (STACK_PAINT ^ (int) &e->stack[i])) break;
+  return e->ints - i;
+}
+
+void stack_monitor_report(void)
+{
+  for(int id = 0; id < STACK_MONITOR_MAX; id++)
+  {
+    if(!stack_monitor_name(id)) continue;
+    int used = stack_monitor_used(id);
+    int size = stack_monitor_size(id);
+    print("%s @%d: %d of %d ints used, %d spare\n", stackEntry[id].name, 
+          (int) stackEntry[id].stack, used, size, size - used);
+  }
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
\ No newline at end of file
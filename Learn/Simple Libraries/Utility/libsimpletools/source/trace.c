@@ -0,0 +1,88 @@
+/*
+ * @file trace.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Source code for trace_name, trace_dump and trace_clear.  The
+ * records themselves are added by trace_put in simpletools.h.
+ */
+
+#include "simpletools.h"
+
+#define TRACE_NAMES 16
+
+trace_buf_t trace_buf[8];
+
+static int traceId[TRACE_NAMES] = {TRACE_ID_ABDRIVE, TRACE_ID_GPS};
+static const char *traceName[TRACE_NAMES] = {"abdrive control", "gps parse"};
+
+void trace_name(int id, const char *name)
+{
+  int i;
+  for(i = 0; i < TRACE_NAMES; i++)
+  {
+    if(!traceName[i] || traceId[i] == id) break;
+  }
+  if(i == TRACE_NAMES) return;
+  traceId[i] = id;
+  traceName[i] = name;
+}
+
+int trace_dump(text_t *device)
+{
+  int n = 0;
+  dprint(device, "C %d\n", CLKFREQ);
+  for(int i = 0; i < TRACE_NAMES && traceName[i]; i++)
+    dprint(device, "N %d %s\n", traceId[i], traceName[i]);
+  for(int cog = 0; cog < 8; cog++)
+  {
+    trace_buf_t *b = &trace_buf[cog];
+    unsigned int t = b->tail;
+    unsigned int h = b->head;
+    while(t != h)
+    {
+      unsigned int cnt = b->rec[t & (TRACE_DEPTH - 1)][0];
+      unsigned int info = b->rec[t & (TRACE_DEPTH - 1)][1];
+      t++;
+      b->tail = t;
+      dprint(device, "%c %d %d %x\n", info >> 16, cog, info & 0xFFFF, cnt);
+      n++;
+    }
+    if(b->dropped) dprint(device, "D %d %d\n", cog, b->dropped);
+  }
+  return n;
+}
+
+void trace_clear(void)
+{
+  for(int cog = 0; cog < 8; cog++)
+  {
+    trace_buf[cog].tail = trace_buf[cog].head;
+    trace_buf[cog].dropped = 0;
+  }
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
\ No newline at end of file
@@ -0,0 +1,206 @@
+/*
+ * @file benchsize.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Host computer program for the Library Benchmarks example.  It
+ * lists the code size of each benchmarked function in a memory model's
+ * .elf file, and compares two saved benchmark runs.
+ *
+ * @details Build with any C compiler for the computer (not the Propeller):
+ *
+ *   cc -O2 -o benchsize benchsize.c
+ *
+ * Usage:
+ *
+ *   benchsize size model file.elf [name...]
+ *   benchsize compare old.csv new.csv [percent]
+ *
+ * size prints size,model,name,bytes for each function (default: the
+ * Library Benchmarks battery), and size,model,image,bytes for everything
+ * the program loads.  Save it together with the benchmark's terminal
+ * output, for example:
+ *
+ *   benchsize size cmm "cmm/Library Benchmarks.elf" >> cmm.csv
+ *
+ * compare matches bench and size lines by kind, model and name, prints
+ * kind,model,name,old,new,percent for each, and ends the line with
+ * ,slower or ,bigger when new is more than percent (default 5) above old.
+ * The exit status is 1 if any line got slower or bigger.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ROWS 1024
+
+static const char *battery[] = {"print", "sprint", "float2string",
+  "i2c_writeByte", "shift_out", "ee_getInt", "interpolate", "dt_fromEt",
+  "ParseRMC", "line", NULL};
+
+typedef struct
+{
+  char key[256];                              // kind,model,name
+  long value;
+} row_t;
+
+
+
+/* ELF files (32-bit little-endian, as PropGCC writes them) */
+
+static unsigned char *elf;
+static long elfSize;
+
+static unsigned long get(long offset, int bytes)
+{
+  unsigned long v = 0;
+  if(offset < 0 || offset + bytes > elfSize) return 0;
+  for(int i = bytes - 1; i >= 0; i--) v = (v << 8) | elf[offset + i];
+  return v;
+}
+
+static int load(const char *name)
+{
+  FILE *f = fopen(name, "rb");
+  if(!f) return -1;
+  fseek(f, 0, SEEK_END);
+  elfSize = ftell(f);
+  rewind(f);
+  elf = malloc(elfSize);
+  if(fread(elf, 1, elfSize, f) != (size_t) elfSize) elfSize = 0;
+  fclose(f);
+  if(elfSize < 52 || memcmp(elf, "\177ELF", 4) || elf[4] != 1 || elf[5] != 1)
+    return -1;
+  return 0;
+}
+
+static int size(const char *model, const char *file, char **names)
+{
+  if(load(file))
+  {
+    fprintf(stderr, "benchsize: %s is not a 32-bit ELF file\n", file);
+    return 2;
+  }
+  long shoff = get(32, 4);
+  int shentsize = get(46, 2), shnum = get(48, 2);
+  long image = 0, symtab = 0, symsize = 0, strtab = 0;
+  for(int i = 0; i < shnum; i++)
+  {
+    long sh = shoff + (long) i * shentsize;
+    int type = get(sh + 4, 4);
+    int flags = get(sh + 8, 4);
+    if((flags & 2) && type != 8) image += get(sh + 20, 4);  // Loaded, not bss
+    if(type == 2)                                             // Symbol table
+    {
+      symtab = get(sh + 16, 4);
+      symsize = get(sh + 20, 4);
+      strtab = get(shoff + (long) get(sh + 24, 4) * shentsize + 16, 4);
+    }
+  }
+  for(int n = 0; names[n]; n++)
+  {
+    long bytes = -1;
+    for(long s = symtab; s + 16 <= symtab + symsize; s += 16)
+    {
+      const char *sym = (const char *) elf + strtab + get(s, 4);
+      if(sym[0] == '_' && strcmp(sym + 1, names[n]) == 0) sym++;  // PropGCC
+      if(strcmp(sym, names[n]) == 0 && (elf[s + 12] & 15) == 2)  // Function
+        bytes = get(s + 8, 4);
+    }
+    if(bytes >= 0) printf("size,%s,%s,%ld\n", model, names[n], bytes);
+    else fprintf(stderr, "benchsize: no function %s in %s\n", names[n], file);
+  }
+  printf("size,%s,image,%ld\n", model, image);
+  return 0;
+}
+
+
+
+/* Comparing runs */
+
+static int read_rows(const char *name, row_t *rows)
+{
+  FILE *f = fopen(name, "r");
+  char line[256];
+  int n = 0;
+  if(!f)
+  {
+    fprintf(stderr, "benchsize: cannot open %s\n", name);
+    exit(2);
+  }
+  while(fgets(line, sizeof(line), f) && n < MAX_ROWS)
+  {
+    if(strncmp(line, "bench,", 6) && strncmp(line, "size,", 5)) continue;
+    char *comma = line;
+    for(int i = 0; i < 3 && comma; i++) comma = strchr(comma + 1, ',');
+    if(!comma) continue;
+    *comma = 0;
+    snprintf(rows[n].key, sizeof(rows[n].key), "%s", line);
+    rows[n++].value = atol(comma + 1);
+  }
+  fclose(f);
+  return n;
+}
+
+static int compare(const char *oldFile, const char *newFile, double percent)
+{
+  static row_t was[MAX_ROWS], now[MAX_ROWS];
+  int nWas = read_rows(oldFile, was), nNow = read_rows(newFile, now);
+  int worse = 0;
+  for(int i = 0; i < nNow; i++)
+  {
+    for(int j = 0; j < nWas; j++)
+    {
+      if(strcmp(now[i].key, was[j].key)) continue;
+      double change = was[j].value ?
+        100.0 * (now[i].value - was[j].value) / was[j].value : 0;
+      printf("%s,%ld,%ld,%.1f", now[i].key, was[j].value, now[i].value,
+             change);
+      if(change > percent)
+      {
+        printf(",%s", now[i].key[0] == 'b' ? "slower" : "bigger");
+        worse = 1;
+      }
+      printf("\n");
+      break;
+    }
+  }
+  return worse;
+}
+
+int main(int argc, char *argv[])
+{
+  if(argc >= 4 && !strcmp(argv[1], "size"))
+    return size(argv[2], argv[3], argc > 4 ? argv + 4 : (char **) battery);
+  if((argc == 4 || argc == 5) && !strcmp(argv[1], "compare"))
+    return compare(argv[2], argv[3], argc == 5 ? atof(argv[4]) : 5);
+  fprintf(stderr, "usage: benchsize size model file.elf [name...]\n"
+                  "       benchsize compare old.csv new.csv [percent]\n");
+  return 2;
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,262 @@
+/*
+ * @file tracedump.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Host computer program that turns trace_dump output saved from 
+ * a terminal into a Chrome trace timeline or flame graph input, and lists 
+ * minimum, average and maximum clock ticks for each region.
+ *
+ * @details Build with any C compiler for the computer (not the Propeller):
+ *
+ *   cc -O2 -o tracedump tracedump.c
+ *
+ * Usage:
+ *
+ *   tracedump [-j | -f | -s] [file]
+ *
+ *   -j  Chrome trace JSON (default).  Open with chrome://tracing or 
+ *       ui.perfetto.dev.  One row per cog.
+ *   -f  Folded stacks (cogN;outer;inner ticks) for flamegraph.pl or 
+ *       speedscope.
+ *   -s  Only the region statistics.
+ *
+ * Reads standard input if there is no file.  Statistics go to standard
+ * error with -j and -f so they do not mix with the output.  Lines that are
+ * not trace records are skipped, so other terminal output can stay in the
+ * file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_DEPTH 32
+#define MAX_REGIONS 256
+#define MAX_STACKS 1024
+
+typedef struct
+{
+  int id;
+  char name[64];
+  long count;
+  unsigned long long total;
+  unsigned long long min;
+  unsigned long long max;
+} region_t;
+
+typedef struct
+{
+  int id;
+  unsigned long long begin;
+  unsigned long long children;
+} frame_t;
+
+typedef struct
+{
+  char path[256];
+  unsigned long long ticks;
+} fold_t;
+
+static region_t region[MAX_REGIONS];
+static int regions;
+static frame_t frame[8][MAX_DEPTH];
+static int depth[8];
+static fold_t folded[MAX_STACKS];
+static int stacks;
+static long dropped[8];
+static double clkfreq = 80000000.0;
+static unsigned long long ref, first;
+static int started, events;
+
+static region_t *region_get(int id)
+{
+  for(int i = 0; i < regions; i++)
+    if(region[i].id == id) return &region[i];
+  if(regions == MAX_REGIONS) return 0;
+  region_t *r = &region[regions++];
+  memset(r, 0, sizeof(*r));
+  r->id = id;
+  r->min = ~0ULL;
+  snprintf(r->name, sizeof(r->name), "region %d", id);
+  return r;
+}
+
+static void json_string(FILE *out, const char *s)
+{
+  fputc('"', out);
+  for(; *s; s++)
+  {
+    if(*s == '"' || *s == '\\') fputc('\\', out);
+    if((unsigned char) *s >= ' ') fputc(*s, out);
+  }
+  fputc('"', out);
+}
+
+static void fold(int cog, int top, unsigned long long ticks)
+{
+  char path[256];
+  int n = snprintf(path, sizeof(path), "cog%d", cog);
+  for(int i = 0; i <= top && n < (int) sizeof(path); i++)
+    n += snprintf(path + n, sizeof(path) - n, ";%s", 
+                  region_get(frame[cog][i].id)->name);
+  for(int i = 0; i < stacks; i++)
+  {
+    if(!strcmp(folded[i].path, path))
+    {
+      folded[i].ticks += ticks;
+      return;
+    }
+  }
+  if(stacks == MAX_STACKS) return;
+  strcpy(folded[stacks].path, path);
+  folded[stacks++].ticks = ticks;
+}
+
+static void region_end(FILE *out, int json, int cog, int id, 
+                       unsigned long long t)
+{
+  int top = depth[cog] - 1;
+  while(top >= 0 && frame[cog][top].id != id) top--;
+  if(top < 0) return;                           // END without BEGIN
+  frame_t *f = &frame[cog][top];
+  unsigned long long ticks = t - f->begin;
+  region_t *r = region_get(id);
+  if(r)
+  {
+    r->count++;
+    r->total += ticks;
+    if(ticks < r->min) r->min = ticks;
+    if(ticks > r->max) r->max = ticks;
+  }
+  fold(cog, top, ticks - f->children);
+  if(top > 0) frame[cog][top - 1].children += ticks;
+  depth[cog] = top;
+  if(json && r)
+  {
+    // Cogs are dumped one at a time, so a later cog's regions can begin
+    // before the first record; their times come out negative.
+    fprintf(out, "%s\n{\"name\":", events++ ? "," : "");
+    json_string(out, r->name);
+    fprintf(out, ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,"
+            "\"dur\":%.3f,\"args\":{\"ticks\":%llu}}", cog,
+            (long long) (f->begin - first) * 1e6 / clkfreq,
+            ticks * 1e6 / clkfreq, ticks);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int mode = 'j';
+  FILE *in = stdin;
+  for(int i = 1; i < argc; i++)
+  {
+    if(argv[i][0] == '-' && strchr("jfs", argv[i][1]) && !argv[i][2])
+      mode = argv[i][1];
+    else if(!(in = fopen(argv[i], "r")))
+    {
+      fprintf(stderr, "usage: tracedump [-j | -f | -s] [file]\n");
+      return 1;
+    }
+  }
+
+  FILE *out = stdout;
+  FILE *stats = mode == 's' ? stdout : stderr;
+  if(mode == 'j') fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+  char line[256];
+  while(fgets(line, sizeof(line), in))
+  {
+    char type;
+    int cog, id, n;
+    unsigned int cnt;
+    line[strcspn(line, "\r\n")] = 0;
+    if(sscanf(line, "C %d", &n) == 1 && line[0] == 'C')
+    {
+      if(n > 0) clkfreq = n;
+    }
+    else if(line[0] == 'N' && sscanf(line, "N %d %n", &id, &n) == 1)
+    {
+      region_t *r = region_get(id);
+      if(r) snprintf(r->name, sizeof(r->name), "%s", line + n);
+    }
+    else if(line[0] == 'D' && sscanf(line, "D %d %d", &cog, &n) == 2)
+    {
+      if(cog >= 0 && cog < 8) dropped[cog] = n;
+    }
+    else if(sscanf(line, "%c %d %d %x", &type, &cog, &id, &cnt) == 4 &&
+            (type == 'B' || type == 'E') && cog >= 0 && cog < 8)
+    {
+      // CNT rolls over about once a minute; extend it to 64 bits assuming
+      // consecutive records are less than half a rollover apart.
+      unsigned long long t;
+      if(!started)
+      {
+        t = first = ref = cnt;
+        started = 1;
+      }
+      else
+        t = ref + (long long) (int) (cnt - (unsigned int) ref);
+      ref = t;
+
+      if(type == 'B')
+      {
+        if(depth[cog] == MAX_DEPTH) continue;
+        frame_t *f = &frame[cog][depth[cog]++];
+        f->id = id;
+        f->begin = t;
+        f->children = 0;
+        region_get(id);
+      }
+      else
+        region_end(out, mode == 'j', cog, id, t);
+    }
+  }
+
+  if(mode == 'j') fprintf(out, "\n]}\n");
+  if(mode == 'f')
+  {
+    for(int i = 0; i < stacks; i++)
+      fprintf(out, "%s %llu\n", folded[i].path, folded[i].ticks);
+  }
+
+  fprintf(stats, "%-24s %8s %12s %12s %12s %10s\n", "region", "count", 
+          "min", "avg", "max", "avg us");
+  for(int i = 0; i < regions; i++)
+  {
+    region_t *r = &region[i];
+    if(!r->count) continue;
+    unsigned long long avg = r->total / r->count;
+    fprintf(stats, "%-24s %8ld %12llu %12llu %12llu %10.2f\n", r->name, 
+            r->count, r->min, avg, r->max, avg * 1e6 / clkfreq);
+  }
+  for(int cog = 0; cog < 8; cog++)
+    if(dropped[cog]) 
+      fprintf(stats, "cog %d dropped %ld records\n", cog, dropped[cog]);
+  return 0;
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
\ No newline at end of file
@@ -56,6 +56,9 @@ extern "C" {
  * memory elements were used by finding the address furthest from the stack
  * base that does not match the sequence.
  *
+ * To keep checking stacks while the finished application runs, without 
+ * changing cog_run calls, see stack_monitor_start in simpletools.
+ *
  * @param *function pointer to a function with no parameters 
  * or return value. Example, if your function is void myFunction(), then
  * pass myFunction. 
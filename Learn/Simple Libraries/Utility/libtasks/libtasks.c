@@ -0,0 +1,96 @@
+/*
+ * @file libtasks.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Project and test harness for the tasks library.  Measures the 
+ * number of clock ticks it takes to switch from one task to another, then 
+ * runs a millisecond counter and two blinking LEDs as tasks in one cog.
+ */
+
+#include "simpletools.h"
+#include "tasks.h"
+
+#define SWITCHES 1000
+
+static volatile int msCount;
+static int pingCount, pongCount;
+static task pingTask, pongTask, msTask, blinkTask[2], reportTask;
+
+TASK(ping)
+{
+  task_begin();
+  while(pingCount < SWITCHES)
+  {
+    pingCount++;
+    task_yield();
+  }
+  task_end();
+}
+
+TASK(pong)
+{
+  task_begin();
+  while(pongCount < SWITCHES)
+  {
+    pongCount++;
+    task_yield();
+  }
+  task_end();
+}
+
+TASK(ms_timer)
+{
+  task_begin();
+  while(1)
+  {
+    task_every(st_msTicks);
+    msCount++;
+  }
+  task_end();
+}
+
+TASK(blink)
+{
+  task_begin();
+  while(1)
+  {
+    toggle((int) task->par);
+    task_pause(100 + 50 * ((int) task->par - 26));
+  }
+  task_end();
+}
+
+TASK(report)
+{
+  task_begin();
+  while(1)
+  {
+    task_pause(1000);
+    print("ms = %d\n", msCount);
+  }
+  task_end();
+}
+
+int main()
+{
+  // Context switch benchmark: two tasks that do nothing but yield.
+  task_start(&pingTask, ping, NULL);
+  task_start(&pongTask, pong, NULL);
+  int t = CNT;
+  task_run();
+  t = CNT - t;
+  print("%d switches, %d ticks, %d ticks per switch\n", 
+        2 * SWITCHES, t, t / (2 * SWITCHES));
+
+  // Processes that would each need their own cog with cog_run.
+  task_start(&msTask, ms_timer, NULL);
+  task_start(&blinkTask[0], blink, (void *) 26);
+  task_start(&blinkTask[1], blink, (void *) 27);
+  task_start(&reportTask, report, NULL);
+  task_run();
+}
+
@@ -0,0 +1,126 @@
+/*
+ * @file tasks.c
+ *
+ * @author Parallax Inc.
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Cooperative task list and scheduler, see tasks.h for documentation.
+ */
+
+#include "tasks.h"
+
+static task_t *taskList;
+static unsigned int taskStep;                 // task_step passes so far
+static int taskStopped;                       // The list lost a task
+
+void task_start(task_t *tsk, int (*function)(task_t *task), void *par)
+{
+  task_t *t;
+  tsk->line = 0;
+  tsk->state = TASK_READY;
+  tsk->wake = CNT;
+  tsk->function = function;
+  tsk->par = par;
+  tsk->step = taskStep;
+  for(t = taskList; t; t = t->next)
+    if(t == tsk) return;
+  tsk->next = taskList;
+  taskList = tsk;
+}
+
+void task_stop(task_t *tsk)
+{
+  task_t **t;
+  for(t = &taskList; *t; t = &(*t)->next)
+  {
+    if(*t == tsk)
+    {
+      *t = tsk->next;
+      tsk->state = TASK_DONE;
+      taskStopped = 1;
+      return;
+    }
+  }
+}
+
+int task_step(void)
+{
+  int ran = 0;
+  task_t *t = taskList;
+  taskStep++;
+  while(t)
+  {
+    if(t->step == taskStep)                   // Already had its turn
+    {
+      t = t->next;
+      continue;
+    }
+    t->step = taskStep;
+    taskStopped = 0;
+    switch(t->state)
+    {
+      case TASK_SLEEP:
+        if((int)(CNT - t->wake) < 0) break;
+        t->state = t->function(t);
+        ran++;
+        break;
+      case TASK_PIN:
+        if((INA & t->mask) != t->match) break;
+        t->state = t->function(t);
+        ran++;
+        break;
+      case TASK_READY:
+        t->state = t->function(t);
+        ran++;
+        break;
+    }
+    if(t->state == TASK_DONE) task_stop(t);
+    // t may have stopped itself or the task after it, so after a stop
+    // start over and skip the tasks that already had their turn
+    t = taskStopped ? taskList : t->next;
+  }
+  return ran;
+}
+
+void task_run(void)
+{
+  while(taskList)
+  {
+    if(task_step()) continue;
+
+    // Nothing was ready.  If every task is sleeping, wait for the first one.
+    unsigned int wake = 0;
+    int sleeping = 0;
+    task_t *t;
+    for(t = taskList; t; t = t->next)
+    {
+      if(t->state != TASK_SLEEP) break;
+      if(!sleeping++ || (int)(t->wake - wake) < 0) wake = t->wake;
+    }
+    if(!t && (int)(wake - CNT) > st_usTicks * 20) waitcnt(wake);
+  }
+}
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,250 @@
+/**
+ * @file tasks.h
+ *
+ * @author Parallax Inc.
+ *
+ * @version 0.5
+ *
+ * @copyright
+ * Copyright (C) Parallax, Inc. 2014. All Rights MIT Licensed.
+ *
+ * @brief Run many small tasks in one cog by taking turns.
+ *
+ * @details Many processes that get their own cog with cog_run spend almost
+ * all their time waiting, then do a little bit of work, like adding 1 to a 
+ * millisecond counter.  With this library, a single cog can run any number of
+ * those processes (tasks).  Each task runs until it has to wait, then gives 
+ * the cog to the next task that is ready.  
+ *
+ * A task is a function declared with TASK(name).  Its code goes between 
+ * task_begin() and task_end(), and it can wait with task_pause, 
+ * task_sleep_until, task_every, task_wait_pin, and task_yield.  For example:
+ *
+ * @code
+ * TASK(blink)
+ * {
+ *   task_begin();
+ *   while(1)
+ *   {
+ *     toggle(26);
+ *     task_pause(100);
+ *   }
+ *   task_end();
+ * }
+ *
+ * task blinkTask;
+ *
+ * int main()
+ * {
+ *   task_start(&blinkTask, blink, NULL);
+ *   task_run();
+ * }
+ * @endcode
+ *
+ * @note A task's local variables do not keep their values while it waits.
+ * Use static or global variables, or a structure passed with task_start's par
+ * parameter, for values that have to last from one wait to the next.  The
+ * wait functions can only be used in the task function itself, not in 
+ * functions it calls, and they cannot be used inside a switch statement.
+ *
+ * @par Core Usage
+ * Tasks run in whichever cog calls task_run.  To run them in the background,
+ * call task_run from a function launched with cog_run.  Start tasks from the
+ * same cog that runs them.
+ *
+ * @par Memory Models
+ * Use with CMM or LMM. 
+ *
+ * @version
+ * 0.5
+ *
+ * @par Help Improve this Library
+ * Please submit bug reports, suggestions, and improvements to this code to
+ * editor@parallax.com.
+ */
+
+#ifndef TASKS_H
+#define TASKS_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "simpletools.h"
+
+/**
+ * @name Task States
+ * @{
+ */
+
+/**
+ * @brief Task is ready to run.
+ */
+#define TASK_READY 0
+
+/**
+ * @brief Task is waiting for CNT to reach its wake time.
+ */
+#define TASK_SLEEP 1
+
+/**
+ * @brief Task is waiting for I/O pin states.
+ */
+#define TASK_PIN   2
+
+/**
+ * @brief Task function has finished.
+ */
+#define TASK_DONE  3
+
+/**
+ * @}
+ */
+
+/**
+ * @brief Task information.  Declare one for each task, and pass its address
+ * to task_start.
+ */
+typedef struct task_st
+{
+  int line;                                   // Where to resume
+  int state;                                  // TASK_READY, TASK_SLEEP...
+  unsigned int wake;                          // CNT to resume at
+  unsigned int mask;                          // Pins to check
+  unsigned int match;                         // Pin states to resume at
+  int (*function)(struct task_st *task);      // Task function
+  void *par;                                  // Optional parameter
+  struct task_st *next;                       // Next task in the list
+  unsigned int step;                          // task_step pass it last ran in
+} task_t;
+
+/**
+ * @brief Simpler type name for use with SimpleIDE.
+ */
+typedef task_t task;
+
+/**
+ * @brief Declare a task function.  Use TASK(myTask) where a regular function 
+ * would have void myTask(void).  Inside the function, task points to the 
+ * task's information, and task->par is the parameter passed to task_start.
+ */
+#define TASK(name) int name(task_t *task)
+
+/**
+ * @brief Must be the first statement in a task function.
+ */
+#define task_begin() switch(task->line) { case 0:
+
+/**
+ * @brief Must be the last statement in a task function.  A task that reaches
+ * it is removed from the list of tasks.
+ */
+#define task_end() } task->line = 0; return TASK_DONE
+
+/**
+ * @brief Let other tasks that are ready run, then continue.
+ */
+#define task_yield() \
+  do { task->line = __LINE__; return TASK_READY; case __LINE__:; } while(0)
+
+/**
+ * @brief Wait until the system clock reaches a certain value.  Other tasks
+ * run in the meantime.
+ *
+ * @param t CNT value to wait for, for example CNT + CLKFREQ/10.
+ */
+#define task_sleep_until(t) \
+  do { task->wake = (t); task->line = __LINE__; return TASK_SLEEP; \
+       case __LINE__:; } while(0)
+
+/**
+ * @brief Wait a certain number of clock ticks after the task's last wake 
+ * time.  Like waitcnt(t += dt), this keeps repeated waits from drifting.
+ *
+ * @param ticks Number of clock ticks between wake times.
+ */
+#define task_every(ticks) task_sleep_until(task->wake + (ticks))
+
+/**
+ * @brief Wait a certain number of pause time increments (1 ms by default, 
+ * see set_pause_dt).  Other tasks run in the meantime.
+ *
+ * @param time Number of time increments.
+ */
+#define task_pause(time) task_sleep_until(CNT + (time) * st_pauseTicks)
+
+/**
+ * @brief Wait until an I/O pin is in a certain state.  Other tasks run in the
+ * meantime.
+ *
+ * @param pin I/O pin number.
+ * @param state 1 to wait for high, 0 to wait for low.
+ */
+#define task_wait_pin(pin, state) \
+  do { task->mask = 1 << (pin); task->match = (state) ? task->mask : 0; \
+       task->line = __LINE__; return TASK_PIN; case __LINE__:; } while(0)
+
+/**
+ * @brief Add a task to the list of tasks run by task_run.  If the task is 
+ * already in the list, it starts over from the beginning.  
+ *
+ * @param *tsk Address of the task's information structure.
+ * @param *function Task function declared with TASK(name).
+ * @param *par Optional parameter the task can access with task->par.
+ */
+void task_start(task_t *tsk, int (*function)(task_t *task), void *par);
+
+/**
+ * @brief Remove a task from the list of tasks.  Can be called from the task
+ * itself.
+ *
+ * @param *tsk Address of the task's information structure.
+ */
+void task_stop(task_t *tsk);
+
+/**
+ * @brief Give each task that is ready one turn.
+ *
+ * @details Use this instead of task_run if your cog has other work to do 
+ * between turns.
+ *
+ * @returns Number of tasks that ran.
+ */
+int task_step(void);
+
+/**
+ * @brief Keep giving tasks turns until all of them are done or stopped.  
+ *
+ * @details When all tasks are sleeping, the cog waits with waitcnt until 
+ * the first one is due.
+ */
+void task_run(void);
+
+#if defined(__cplusplus)
+}
+#endif
+/* __cplusplus */ 
+#endif
+/* TASKS_H */ 
+
+/**
+ * TERMS OF USE: MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */